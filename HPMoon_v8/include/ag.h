@@ -11,6 +11,7 @@
 /********************************* Includes *******************************/
 
 #include "clUtils.h"
+#include "transport.h"
 #include <mpi.h>
 
 /********************************* Methods ********************************/
@@ -29,9 +30,24 @@ Individual* createSubpopulations(const Config *const conf);
  * @param subpops The initial subpopulations
  * @param devicesObject Structure containing the OpenCL variables of a device
  * @param trDataBase The training database which will contain the instances and the features
+ * @param trStream The growing training database of the streaming mode, or NULL
  * @param selInstances The instances choosen as initial centroids
+ * @param transport The transport used to exchange the subpopulations between the master and the workers, and the migrants between the workers
+ * @param conf The structure with all configuration parameters. The number of training instances grows in the streaming mode
+ */
+void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, DataBaseStream *const trStream, const int *const selInstances, Transport *const transport, Config *const conf);
+
+
+/**
+ * @brief Island-based genetic algorithm model over a simulated cluster. The master and the workers are threads of this process which exchange the subpopulations in memory
+ * @param subpops The initial subpopulations
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param transposedTrDataBase The transposed training database
+ * @param selInstances The instances choosen as initial centroids
+ * @param argc Number of arguments of the program, used to get the configuration of each simulated process
+ * @param argv Arguments of the program
  * @param conf The structure with all configuration parameters
  */
-void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, const Config *const conf);
+void agIslandsSimulated(Individual *const subpops, const float *const trDataBase, const float *const transposedTrDataBase, const int *const selInstances, const int argc, const char **argv, const Config *const conf);
 
 #endif
@@ -11,6 +11,9 @@
 /********************************* Includes *******************************/
 
 #include "config.h" // "Config" datatype
+#include <mpi.h>
+#include <stdint.h> // uint32_t, uint64_t
+#include <vector> // std::vector...
 
 /******************************** Constants *******************************/
 
@@ -19,11 +22,282 @@ const char *const BD_ERROR_FILE_EMPTY = "Error: The database file is empty";
 const char *const BD_ERROR_ROW_UNEQUAL = "Error: Different number of columns in the row";
 const char *const BD_ERROR_DIMENSIONS_MIN = "Error: The database dimensions must be 4x4 or higher";
 const char *const BD_ERROR_INSTANCES_RANGE = "Error: The number of instances must be between 4 and";
-const char *const BD_ERROR_COLUMNS_UNEQUAL = "Error: The number of columns in the database must match the specified \"N_FEATURES\" parameter when compiling the program";
+const char *const BD_ERROR_COLUMNS_UNEQUAL = "Error: The number of columns in the database has changed since its first row or its header was read";
+const char *const BD_ERROR_BINARY_FORMAT = "Error: The binary database file is corrupt or it has an unsupported version";
+const char *const BD_ERROR_FILE_WRITE = "Error: Could not write the binary database file";
+const char *const BD_ERROR_OUT_OF_CORE_FORMAT = "Error: The out-of-core mode requires a binary database, which must have been normalized by \"hpmoon-convert -norm\" if the normalization is required";
+const char *const BD_ERROR_CONVERT_ARGUMENTS = "Error: The names of the text and binary database files are required";
+const char *const BD_ERROR_STREAM_FORMAT = "Error: The streaming mode requires a text database with blank-separated values";
+const char *const BD_ERROR_SPARSE_ROW = "Error: Wrong \"feature:value\" pair or features not in increasing order in the row";
+
+const uint32_t BD_BINARY_MAGIC = 0x42444D48; // "HMDB" in little endian
+const uint32_t BD_BINARY_VERSION = 1;
+const uint64_t BD_BINARY_ALIGNMENT = 4096;
+
+const int BD_QUANTIZED_LEVELS = 127; // 7 bits, so the differences between quantized values fit in the signed operand of the 8-bit dot products
+const int BD_QUANTIZED_ALIGNMENT = 32; // The quantized instances are padded to whole 256-bit vectors
+
+/******************************** Structures ******************************/
+
+/**
+ * @brief Header of the binary columnar database files generated by "hpmoon-convert"
+ *
+ * The instances are stored after the header in row-major order, and then in feature-major order (transposed). Both blocks are aligned to "BD_BINARY_ALIGNMENT" bytes, so they are mapped in memory as they are
+ */
+typedef struct BinaryDataBaseHeader {
+
+
+	/**
+	 * @brief The identifier of the format and its version
+	 */
+	uint32_t magic;
+	uint32_t version;
+
+
+	/**
+	 * @brief The database dimensions
+	 */
+	uint32_t nInstances;
+	uint32_t nFeatures;
+
+
+	/**
+	 * @brief If the instances were already normalized (using all instances) when the file was generated
+	 */
+	uint32_t normalized;
+	uint32_t reserved;
+
+
+	/**
+	 * @brief The offsets in bytes of the row-major block and of the feature-major block
+	 */
+	uint64_t rowsOffset;
+	uint64_t transposedOffset;
+
+} BinaryDataBaseHeader;
+
+
+/**
+ * @brief Training database quantized to 8 bits, used by the CPU threads to evaluate the individuals with integer dot products
+ *
+ * Each value is stored as "round((x - offset[f]) / scale)", between 0 and "BD_QUANTIZED_LEVELS". All features share the scale, so the Euclidean distances between quantized instances are proportional to the real ones
+ */
+typedef struct QuantizedDataBase {
+
+
+	/**
+	 * @brief The quantized instances in row-major order. Each instance is padded with zeros up to "stride" values
+	 */
+	std::vector<unsigned char> values;
+
+
+	/**
+	 * @brief The distance in values between consecutive instances
+	 */
+	int stride;
+
+
+	/**
+	 * @brief The minimum value of each feature, which is quantized as 0
+	 */
+	std::vector<float> offset;
+
+
+	/**
+	 * @brief The difference between consecutive quantized values
+	 */
+	float scale;
+
+} QuantizedDataBase;
+
+
+/**
+ * @brief Training database whose instances are mostly zeros, stored in compressed sparse column format (CSC). Only the non-zero values are kept, so databases with hundreds of thousands of features fit in memory, and the values of the features selected by an individual are visited without touching the rest
+ */
+typedef struct SparseDataBase {
+
+
+	/**
+	 * @brief The position in "instances" and "values" of the first non-zero value of each feature. The last position is the total number of non-zero values
+	 */
+	std::vector<size_t> featureOffsets;
+
+
+	/**
+	 * @brief The instance of each non-zero value, in increasing order inside each feature
+	 */
+	std::vector<int> instances;
+
+
+	/**
+	 * @brief The non-zero values
+	 */
+	std::vector<float> values;
+
+} SparseDataBase;
+
+
+/**
+ * @brief Training database which grows while the algorithm runs, because new instances are appended to its text file (streaming mode)
+ *
+ * Only the complete lines of the file are read. The appended instances are normalized with the statistics of the instances available when the execution started, so the instances already read do not change
+ */
+typedef struct DataBaseStream {
+
+
+	/**
+	 * @brief The instances in row-major order. There is room for "capacity" instances, so the instances do not move when the database grows
+	 */
+	std::vector<float> instances;
+
+
+	/**
+	 * @brief The maximum number of instances
+	 */
+	int capacity;
+
+
+	/**
+	 * @brief The position in the file after the last line read
+	 */
+	size_t fileOffset;
+
+
+	/**
+	 * @brief The average and the inverse of the standard deviation of each feature, or empty vectors if the database is not normalized
+	 */
+	std::vector<float> featureAverage;
+	std::vector<float> invDeviation;
+
+} DataBaseStream;
+
 
 
 /********************************* Methods ********************************/
 
+/**
+ * @brief The database is normalized between 0.0 and 1.0. The statistics of the features are computed in a single row-wise pass and the instances are normalized in a second pass, both in parallel
+ * @param dataBase Database to be normalized
+ * @param transposedDataBase The place where the normalized database is also stored already transposed, or NULL
+ * @param nInstances The number of instances of the database
+ * @param nFeatures The number of features of each instance
+ */
+void normDataBase(float *const dataBase, float *const transposedDataBase, const int nInstances, const int nFeatures);
+
+
+/**
+ * @brief Reads all the instances of a database stored as text, whose features are separated by blanks. The file is parsed in parallel in a single pass
+ * @param fileName The name of the database file
+ * @param nRows Output number of instances
+ * @param nCols Output number of features
+ * @return The instances
+ */
+float* readTextDataBase(const char *const fileName, int *const nRows, int *const nCols);
+
+
+/**
+ * @brief Writes a database in the binary columnar format
+ * @param fileName The name of the binary database file
+ * @param dataBase The instances
+ * @param nInstances The number of instances of the database
+ * @param nFeatures The number of features of each instance
+ * @param normalized If the instances are already normalized
+ */
+void writeBinaryDataBase(const char *const fileName, const float *const dataBase, const int nInstances, const int nFeatures, const bool normalized);
+
+
+/**
+ * @brief Checks if the database file is stored in the binary columnar format
+ * @param conf The structure with all configuration parameters
+ * @return True if the file starts with the identifier of the binary format or false otherwise
+ */
+bool isBinaryDataBase(const Config *const conf);
+
+
+/**
+ * @brief Checks if the database file is stored as sparse text, whose instances are lists of "feature:value" pairs
+ * @param conf The structure with all configuration parameters
+ * @return True if the first non-empty line contains a pair or false otherwise
+ */
+bool isSparseDataBase(const Config *const conf);
+
+
+/**
+ * @brief Gets the number of features of the database from the header of a binary database, from the first row of a text database or from the greatest feature of a sparse database
+ * @param conf The structure with all configuration parameters
+ * @return The number of features
+ */
+int getDataBaseFeatures(const Config *const conf);
+
+
+/**
+ * @brief Reads a database stored in the binary columnar format. The file is mapped in memory, so the instances are copied without parsing them or transposing them
+ * @param dataBase The place where the instances will be stored
+ * @param transposedDataBase The place where the transposed instances will be stored, or NULL if they are not needed
+ * @param conf The structure with all configuration parameters
+ */
+void readBinaryDataBase(float *const dataBase, float *const transposedDataBase, const Config *const conf);
+
+
+/**
+ * @brief Maps the instances of a binary database in memory for the out-of-core mode. The operating system reads them from the file when they are accessed and discards them when the memory is needed, so the database can be larger than the memory
+ * @param conf The structure with all configuration parameters
+ * @return The instances in row-major order. They must be released with "unmapDataBase"
+ */
+const float* mapDataBase(const Config *const conf);
+
+
+/**
+ * @brief Releases the instances mapped in memory for the out-of-core mode
+ * @param trDataBase The instances returned by "mapDataBase"
+ * @param conf The structure with all configuration parameters
+ */
+void unmapDataBase(const float *const trDataBase, const Config *const conf);
+
+
+/**
+ * @brief Quantizes the training database to 8 bits. The range of the features is computed and the instances are quantized in parallel
+ * @param trDataBase The training database, already normalized if it is required
+ * @param conf The structure with all configuration parameters
+ * @return The quantized database
+ */
+QuantizedDataBase* quantizeDataBase(const float *const trDataBase, const Config *const conf);
+
+
+/**
+ * @brief Reads a sparse text database in compressed sparse column format and normalizes it if it is required. The file is parsed in parallel
+ * @param conf The structure with all configuration parameters
+ * @return The database
+ */
+SparseDataBase* readSparseDataBase(const Config *const conf);
+
+
+/**
+ * @brief Reads the instances already available in a text database for the streaming mode and normalizes them if it is required. The number of instances in the configuration is the capacity of the database, and it is replaced by the number of instances read
+ * @param conf The structure with all configuration parameters
+ * @return The growing database
+ */
+DataBaseStream* openDataBaseStream(Config *const conf);
+
+
+/**
+ * @brief Appends to the database the complete lines added to its text file since the last call, until the database is full. The lines are parsed in parallel and normalized if it is required
+ * @param stream The growing database
+ * @param conf The structure with all configuration parameters. The number of instances is updated
+ * @return The number of appended instances
+ */
+int appendDataBaseStream(DataBaseStream *const stream, Config *const conf);
+
+
+/**
+ * @brief Reads and normalizes a database if it is required. The instances are stored directly in their final places
+ * @param dataBase The place where the instances will be stored
+ * @param transposedDataBase The place where the transposed instances will be stored, or NULL if they are not needed
+ * @param conf The structure with all configuration parameters
+ */
+void getDataBases(float *const dataBase, float *const transposedDataBase, const Config *const conf);
+
+
 /**
  * @brief Reads and normalizes a database if it is required
  * @param conf The structure with all configuration parameters
@@ -35,9 +309,30 @@ float* getDataBase(const Config *const conf);
 /**
  * @brief The database is transposed
  * @param dataBase Database to be transposed
+ * @param transposedDataBase The place where the database will be stored already transposed
+ * @param conf The structure with all configuration parameters
+ */
+void transposeDataBase(const float *const dataBase, float *const transposedDataBase, const Config *const conf);
+
+
+/**
+ * @brief Broadcasts the already normalized database as binary floats from the rank 0 of the communicator
+ * @param dataBase The database. Only the rank 0 must provide its content
+ * @param comm Communicator with the ranks which receive the database
+ * @param conf The structure with all configuration parameters
+ */
+void broadcastDataBase(float *const dataBase, const MPI_Comm comm, const Config *const conf);
+
+
+/**
+ * @brief Reads the database and its transposed copy once per node into an MPI shared memory window
+ * @param trDataBase Output pointer to the shared database
+ * @param transposedTrDataBase Output pointer to the shared transposed database
+ * @param window Output window holding both databases. It must be released with "MPI_Win_free"
+ * @param nodeComm Communicator with the worker ranks running on the same node
+ * @param leadersComm Communicator with the master (rank 0) and the owner of each node. If it is "MPI_COMM_NULL", the owner reads the database file by itself
  * @param conf The structure with all configuration parameters
- * @return The database already transposed
  */
-float* transposeDataBase(const float *const dataBase, const Config *const conf);
+void getSharedDataBases(const float **const trDataBase, const float **const transposedTrDataBase, MPI_Win *const window, const MPI_Comm nodeComm, const MPI_Comm leadersComm, const Config *const conf);
 
 #endif
@@ -0,0 +1,67 @@
+/**
+ * @file checkpoint.h
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief Header file for writing and reading the binary checkpoints of the islands-based genetic algorithm
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+/********************************* Includes *******************************/
+
+#include "individual.h" // Individual, packSubpopulations...
+
+/******************************** Constants *******************************/
+
+const char *const CP_ERROR_FILE_OPEN = "Error: Could not open the checkpoint file";
+const char *const CP_ERROR_FILE_WRITE = "Error: Could not write the checkpoint file";
+const char *const CP_ERROR_FILE_FORMAT = "Error: The checkpoint file is corrupt or it does not match the current configuration";
+const int CP_RANDOM_STATE_SIZE = 128; // Bytes of the state of the random generator, which is stored in the checkpoints. It is the size of the default state of "random()"
+const float RANDOM_MAX = 2147483647.0f; // Maximum value returned by "random()"
+
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Seeds the random generator used by "random()". Its state is kept by this module, so the checkpoints can store and restore it without altering the sequence of random numbers
+ * @param seed The seed
+ */
+void seedRandom(const unsigned int seed);
+
+
+/**
+ * @brief Writes a checkpoint with the state of the algorithm at a migration boundary. The file is written by a background thread, so the evolution is not paused
+ * @param subpops The subpopulations. Only their parents are stored
+ * @param nIndsFronts0 The number of individuals in the front 0 of each subpopulation
+ * @param selInstances The instances choosen as initial centroids
+ * @param nextMigration The index of the next global migration to be performed
+ * @param conf The structure with all configuration parameters
+ */
+void writeCheckpoint(const Individual *const subpops, const int *const nIndsFronts0, const int *const selInstances, const int nextMigration, const Config *const conf);
+
+
+/**
+ * @brief Waits until the last checkpoint has been completely written. If it could not be written, the execution is aborted
+ */
+void waitCheckpoint();
+
+
+/**
+ * @brief Reads the subpopulations from the latest checkpoint and restores the state of the random generator
+ * @param subpops The place where the subpopulations will be stored
+ * @param nIndsFronts0 The number of individuals in the front 0 of each subpopulation
+ * @param conf The structure with all configuration parameters
+ * @return The index of the next global migration to be performed
+ */
+int readCheckpoint(Individual *const subpops, int *const nIndsFronts0, const Config *const conf);
+
+
+/**
+ * @brief Reads the initial centroids from the latest checkpoint
+ * @param conf The structure with all configuration parameters
+ * @return The instances choosen as initial centroids
+ */
+int* readCheckpointCentroids(const Config *const conf);
+
+#endif
@@ -10,6 +10,7 @@
 
 /********************************* Includes *******************************/
 
+#include "bd.h" // QuantizedDataBase, SparseDataBase
 #include "individual.h" // Individual
 #include <CL/cl.h> // OpenCL
 #include <vector> // std::vector...
@@ -34,17 +35,19 @@ const char *const CL_ERROR_PROGRAM_BUILD = "Error: Could not create the program"
 const char *const CL_ERROR_PROGRAM_ERRORS = "Error: Could not get the compilation errors";
 const char *const CL_ERROR_KERNEL_BUILD = "Error: Could not create the kernel";
 const char *const CL_ERROR_OBJECT_SUBPOPS = "Error: Could not create the OpenCL object containing the subpopulations";
-const char *const CL_ERROR_OBJECT_TRDB = "Error: Could not create the OpenCL object containing the training database";
+const char *const CL_ERROR_OBJECT_COLUMNS = "Error: Could not create the OpenCL objects containing the columns of the training database used by the individuals";
 const char *const CL_ERROR_OBJECT_CENTROIDS = "Error: Could not create the OpenCL object containing the indexes of the initial centroids";
 const char *const CL_ERROR_KERNEL_ARGUMENT1 = "Error: Could not set the first kernel argument";
 const char *const CL_ERROR_KERNEL_ARGUMENT2 = "Error: Could not set the second kernel argument";
 const char *const CL_ERROR_KERNEL_ARGUMENT3 = "Error: Could not set the third kernel argument";
-const char *const CL_ERROR_ENQUEUE_TRDB = "Error: Could not enqueue the OpenCL object containing the training database";
 const char *const CL_ERROR_ENQUEUE_CENTROIDS = "Error: Could not enqueue the OpenCL object containing the init centroids";
 const char *const CL_ERROR_OBJECT_TTRDB = "Error: Could not create the OpenCL object containing the transposed training database";
 const char *const CL_ERROR_ENQUEUE_TTRDB = "Error: Could not enqueue the OpenCL object containing the transposed training database";
-const char *const CL_ERROR_KERNEL_ARGUMENT6 = "Error: Could not set the sixth kernel argument";
 const char *const CL_ERROR_DEVICE_FOUND = "Error: Not exists the specified device";
+const char *const CL_ERROR_KERNEL_RESIDENT = "Error: Could not create the kernels with the genetic operators";
+const char *const CL_ERROR_OBJECT_RESIDENT = "Error: Could not create the OpenCL objects used by the genetic operators";
+const char *const CL_ERROR_KERNEL_ARGUMENT_COLUMNS = "Error: Could not set the arguments of the kernel which compacts the columns of the training database";
+const char *const CL_ERROR_KERNEL_ARGUMENT_RESIDENT = "Error: Could not set the arguments of the kernels with the genetic operators";
 
 /********************************* Structures ********************************/
 
@@ -85,9 +88,27 @@ typedef struct CLDevice {
 
 
 	/**
-	 * @brief OpenCL object which contains the training database
+	 * @brief The OpenCL kernel which compacts the columns of the training database used by the individuals of a batch
 	 */
-	cl_mem objTrDataBase;
+	cl_kernel kernelColumns;
+
+
+	/**
+	 * @brief OpenCL object which contains the features of the columns used by the individuals of the current batch
+	 */
+	cl_mem objColumns;
+
+
+	/**
+	 * @brief OpenCL object which contains the columns of the transposed training database used by the individuals of the current batch
+	 */
+	cl_mem objColumnsTrDataBase;
+
+
+	/**
+	 * @brief The number of columns which fit in "objColumnsTrDataBase". It is only allocated when a batch needs it
+	 */
+	int columnsCapacity;
 
 
 	/**
@@ -108,12 +129,60 @@ typedef struct CLDevice {
 	cl_mem objTransposedTrDataBase;
 
 
+	/**
+	 * @brief The OpenCL kernel with the implementation of the tournament, the crossover and the mutation (only in device-resident mode)
+	 */
+	cl_kernel kernelCrossover;
+
+
+	/**
+	 * @brief The OpenCL kernel with the implementation of the fitness normalization (only in device-resident mode)
+	 */
+	cl_kernel kernelNormalize;
+
+
+	/**
+	 * @brief The OpenCL kernel with the implementation of the survivors selection (only in device-resident mode)
+	 */
+	cl_kernel kernelSurvivors;
+
+
+	/**
+	 * @brief OpenCL object used to sort the survivors (only in device-resident mode)
+	 */
+	cl_mem objSurvivors;
+
+
+	/**
+	 * @brief OpenCL object which contains the number of children generated in the current generation (only in device-resident mode)
+	 */
+	cl_mem objNChildren;
+
+
+	/**
+	 * @brief OpenCL object which contains the number of individuals in the first front (only in device-resident mode)
+	 */
+	cl_mem objNIndsFront0;
+
+
 	/**
 	 * @brief The number of compute units specified for this device
 	 */
 	int computeUnits;
 
 
+	/**
+	 * @brief The training database quantized to 8 bits (only in the CPU device if it is enabled in configuration)
+	 */
+	QuantizedDataBase *quantizedTrDataBase;
+
+
+	/**
+	 * @brief The training database in compressed sparse column format (only in the CPU device if the database is sparse)
+	 */
+	SparseDataBase *sparseTrDataBase;
+
+
 	/**
 	 * @brief The number of global work-items specified for this device
 	 */
@@ -30,6 +30,17 @@ const char *const CFG_ERROR_CU_LOWER = "Error: Specified lower number of compute
 const char *const CFG_ERROR_WI_LOWER = "Error: Specified lower number of local work-items than number of devices";
 const char *const CFG_ERROR_THREADS_MIN = "Error: The number of CPU threads must be 0 or higher if the number of devices is 0, or 1 otherwise";
 const char *const CFG_ERROR_FEATURES_MIN = "Error: The number of features must be 4 or higher";
+const char *const CFG_ERROR_BATCH_STEADY = "Error: The batched evaluation of the subpopulations can not be combined with the steady-state mode";
+const char *const CFG_ERROR_TOPOLOGY = "Error: The migration topology must be \"master\", \"ring\", \"torus\" or \"random\"";
+const char *const CFG_ERROR_CHECKPOINT_TOPOLOGY = "Error: The checkpoints can only be used with the \"master\" migration topology";
+const char *const CFG_ERROR_MASTER_WORKER = "Error: The master can only evolve subpopulations with the \"master\" migration topology";
+const char *const CFG_ERROR_SIMULATION = "Error: The simulated workers require a single MPI process";
+const char *const CFG_ERROR_RESUME = "Error: The name of the checkpoint file is required to resume the execution";
+const char *const CFG_ERROR_RESIDENT_MODE = "Error: The device-resident mode can not be combined with the steady-state mode or the batched evaluation";
+const char *const CFG_ERROR_OUT_OF_CORE = "Error: The out-of-core mode can only evaluate the individuals on CPU threads, without OpenCL devices";
+const char *const CFG_ERROR_QUANTIZE = "Error: The quantized database can only be used by CPU threads, without OpenCL devices, and it cannot be combined with the out-of-core mode";
+const char *const CFG_ERROR_SPARSE = "Error: The sparse databases can only be used by CPU threads, without OpenCL devices, and they cannot be combined with the out-of-core mode or the quantized database";
+const char *const CFG_ERROR_STREAM = "Error: The streaming mode requires a single MPI process, without simulated workers, whose CPU threads evaluate the individuals, and it cannot be combined with the out-of-core mode, the quantized database or a sparse database";
 const char *const CFG_ERROR_SIZE_MIN = "Error: The minimum number of MPI processes must be 1 or higher";
 
 /******************************** Structures ******************************/
@@ -90,6 +101,18 @@ typedef struct Config {
 	std::string imageFileName;
 
 
+	/**
+	 * @brief The parameter indicating the name of the binary file where the final Pareto front is written. If it is empty, the results file is not written
+	 */
+	std::string resultsFileName;
+
+
+	/**
+	 * @brief The parameter indicating if the parents of all subpopulations are also written into the results file
+	 */
+	bool resultsWorld;
+
+
 	/**
 	 * @brief The parameter indicating the number of training instances of the database
 	 */
@@ -108,12 +131,84 @@ typedef struct Config {
 	bool trNormalize;
 
 
+	/**
+	 * @brief The parameter indicating if the training database is streamed from its memory-mapped binary file instead of being loaded in memory (out-of-core mode)
+	 */
+	bool trOutOfCore;
+
+
+	/**
+	 * @brief The parameter indicating if the CPU threads evaluate the individuals over an 8-bit quantized copy of the training database
+	 */
+	bool trQuantize;
+
+
+	/**
+	 * @brief The parameter indicating if the lines appended to the text training database are added to it at each migration. The maximum number of training instances is the capacity of the database
+	 */
+	bool trStream;
+
+
 	/**
 	 * @brief The parameter indicating the number of individuals competing in the tournament
 	 */
 	int tourSize;
 
 
+	/**
+	 * @brief The parameter indicating if the subpopulations are evolved in asynchronous steady-state mode instead of generation by generation
+	 */
+	bool steadyState;
+
+
+	/**
+	 * @brief The parameter indicating if the children of all subpopulations are evaluated in a single batch (only when there is a single MPI process)
+	 */
+	bool batchIslands;
+
+
+	/**
+	 * @brief The parameter indicating if the genetic operators are also executed on the GPU which evolves the subpopulation (only when the subpopulation is evolved by a single GPU)
+	 */
+	bool deviceResident;
+
+
+	/**
+	 * @brief The parameter indicating the migration topology. With "master", the subpopulations are sent to the master in each migration. With "ring", "torus" or "random", the workers directly exchange the migrants and the subpopulations stay in the workers
+	 */
+	std::string migrationTopology;
+
+
+	/**
+	 * @brief The parameter indicating the name of the file where a checkpoint is written in each migration. If it is empty, no checkpoints are written
+	 */
+	std::string checkpointFileName;
+
+
+	/**
+	 * @brief The parameter indicating if the execution must be resumed from the latest checkpoint
+	 */
+	bool resume;
+
+
+	/**
+	 * @brief The parameter indicating if the master also evolves subpopulations over its own devices while it distributes the rest (only when there are several MPI processes)
+	 */
+	bool masterWorker;
+
+
+	/**
+	 * @brief The parameter indicating the number of workers simulated by threads of a single process, which exchange the subpopulations in memory. If it is 0, no workers are simulated
+	 */
+	int simWorkers;
+
+
+	/**
+	 * @brief The parameter indicating if the final Pareto front is evaluated again on the OpenCL devices and on the CPU to report the fitness error of the devices
+	 */
+	bool verifyDevices;
+
+
 	/**
 	 * @brief The parameter indicating the number of OpenCL devices to perform the evaluation of the individuals
 	 */
@@ -195,6 +290,12 @@ typedef struct Config {
 	int nFeatures;
 
 
+	/**
+	 * @brief The parameter indicating if the training database is stored as sparse text, so it is kept in compressed sparse column format. It is detected from the database file. The chromosomes are not sparse, so very wide databases are limited by the memory and the copies of the individuals
+	 */
+	bool trSparse;
+
+
 	/**
 	 * @brief The parameter indicating the number of objectives
 	 */
@@ -219,9 +320,11 @@ typedef struct Config {
 	 * @brief The constructor with parameters
 	 * @param argc Number of arguments
 	 * @param argv The command-line parameters
+	 * @param rank The rank of the process. If it is negative, the rank in "MPI_COMM_WORLD" is used
+	 * @param size The number of processes. If it is negative, the size of "MPI_COMM_WORLD" is used
 	 * @return An object containing all configuration parameters
 	 */
-	Config(const int argc, const char **argv);
+	Config(const int argc, const char **argv, int rank = -1, int size = -1);
 
 
 	/**
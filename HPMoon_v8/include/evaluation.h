@@ -17,12 +17,17 @@
 const char *const EV_ERROR_ENQUEUE_INDIVIDUALS = "Error: Could not enqueue the OpenCL object containing the individuals";
 const char *const EV_ERROR_KERNEL_ARGUMENT4 = "Error: Could not set the fourth kernel argument";
 const char *const EV_ERROR_KERNEL_ARGUMENT5 = "Error: Could not set the fifth kernel argument";
+const char *const EV_ERROR_KERNEL_ARGUMENT6 = "Error: Could not set the sixth kernel argument";
+const char *const EV_ERROR_KERNEL_ARGUMENT7 = "Error: Could not set the seventh kernel argument";
+const char *const EV_ERROR_ENQUEUE_COLUMNS = "Error: Could not compact the columns of the training database used by the individuals";
 const char *const EV_ERROR_ENQUEUE_KERNEL = "Error: Could not run the kernel";
 const char *const EV_ERROR_ENQUEUE_READING = "Error: Could not read the data from the device";
 const char *const EV_ERROR_DATA_OPEN = "Error: An error ocurred opening or writting the data file";
 const char *const EV_ERROR_PLOT_OPEN = "Error: An error ocurred opening or writting the plot file";
 const char *const EV_ERROR_OBJECTIVES_NUMBER = "Error: Gnuplot is only available for two objectives by now. Not generated gnuplot file";
 
+const size_t EV_BLOCK_BYTES = 1 << 20; // Size of the blocks of instances streamed in the out-of-core mode
+
 /********************************* Methods ********************************/
 
 
@@ -38,6 +43,107 @@ const char *const EV_ERROR_OBJECTIVES_NUMBER = "Error: Gnuplot is only available
 void evaluationCPU(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf);
 
 
+/**
+ * @brief Evaluation of each individual in CPU for the out-of-core mode. The instances are streamed in blocks from the memory-mapped database, so each block is read once per K-means iteration and used by all the individuals while it is in cache. The K-means accumulators of each individual are carried across the blocks
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationCPUBlocks(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf);
+
+
+/**
+ * @brief Evaluation of each individual in CPU over the training database quantized to 8 bits. The distances are computed with integer dot products, while the centroids are kept in floating point and quantized again in each iteration
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param quantizedTrDataBase The quantized training database
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationCPUQuantized(Individual *const subpop, const int nIndividuals, const QuantizedDataBase *const quantizedTrDataBase, const int *const selInstances, const int nThreads, const Config *const conf);
+
+
+/**
+ * @brief Reports the error of the fitness obtained over the quantized training database. The individuals are evaluated again over the quantized database and over the original one, and the relative error of each objective is printed
+ * @param subpop The individuals, usually the final front 0
+ * @param nIndividuals The number of individuals
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void reportQuantizationError(const Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const Config *const conf);
+
+
+/**
+ * @brief Reports the error of the fitness obtained on the OpenCL devices. The individuals are evaluated again on the devices, which only stream the columns selected by them, and on the CPU, and the relative error of each objective is printed
+ * @param subpop The individuals, usually the final front 0
+ * @param nIndividuals The number of individuals
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void reportDevicesError(const Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf);
+
+
+/**
+ * @brief Evaluation of each individual in CPU over the sparse training database. Only the non-zero values of the selected features are visited, and the distances are obtained from the dot products with the centroids, the squared norms of the centroids and the squared norms of the instances, which are precomputed once per individual
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param sparseTrDataBase The sparse training database
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationCPUSparse(Individual *const subpop, const int nIndividuals, const SparseDataBase *const sparseTrDataBase, const int *const selInstances, const int nThreads, const Config *const conf);
+
+
+/**
+ * @brief Estimates the cost of evaluating an individual
+ * @param ind The individual
+ * @param conf The structure with all configuration parameters
+ * @return The approximate number of operations of K-means for the individual
+ */
+long int estimateCost(const Individual *const ind, const Config *const conf);
+
+
+/**
+ * @brief Reorders the individuals in place. They are swapped, so their chromosomes are neither copied nor reallocated
+ * @param individuals The individuals
+ * @param order The current position of the individual which must be placed in each position
+ */
+void permuteIndividuals(Individual *const individuals, const std::vector<int> &order);
+
+
+/**
+ * @brief Sets the columns of the training database streamed by the K-means kernel of a GPU. If they are at most half of the features, they are compacted on the device from the transposed database
+ * @param device Structure containing the OpenCL variables of a GPU device
+ * @param columns The features selected by some individual of the batch, in increasing order
+ * @param conf The structure with all configuration parameters
+ * @param event Output event of the compaction
+ * @return True if the compaction has been enqueued, so the kernel must wait for "event", or false otherwise
+ */
+bool setColumns(CLDevice *const device, const std::vector<cl_int> &columns, const Config *const conf, cl_event *const event);
+
+
+/**
+ * @brief Evaluation of each individual on OpenCL devices. The fitness is not normalized
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationDevices(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf);
+
+
 /**
  * @brief Evaluation of each individual on OpenCL devices
  * @param subpop The first individual to evaluate of the current subpopulation
@@ -52,7 +158,44 @@ void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *cons
 
 
 /**
- * @brief Normalize the fitness for each individual
+ * @brief Evaluation of the individuals of several subpopulations in a single batch. The individuals are gathered, evaluated at once by all devices and scattered back to their subpopulations
+ * @param subpops The subpopulations
+ * @param nSubpopulations The number of subpopulations
+ * @param offset The position of the first individual to evaluate inside each subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated in each subpopulation
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationIslands(Individual *const subpops, const int nSubpopulations, const int offset, const int *const nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf);
+
+
+/**
+ * @brief Computes the average and the standard deviation of each objective
+ * @param subpop The first individual of the current subpopulation
+ * @param nIndividuals The number of individuals
+ * @param average Output average of each objective
+ * @param deviation Output standard deviation of each objective
+ * @param conf The structure with all configuration parameters
+ */
+void getFitnessStatistics(const Individual *const subpop, const int nIndividuals, float *const average, float *const deviation, const Config *const conf);
+
+
+/**
+ * @brief Normalize the fitness for each individual with the given statistics of each objective
+ * @param subpop The first individual to normalize of the current subpopulation
+ * @param nIndividuals The number of individuals which will be normalized
+ * @param average The average of each objective
+ * @param deviation The standard deviation of each objective
+ * @param conf The structure with all configuration parameters
+ */
+void normalizeFitness(Individual *const subpop, const int nIndividuals, const float *const average, const float *const deviation, const Config *const conf);
+
+
+/**
+ * @brief Normalize the fitness for each individual with the statistics of the individuals themselves
  * @param subpop The first individual to normalize of the current subpopulation
  * @param nIndividuals The number of individuals which will be normalized
  * @param conf The structure with all configuration parameters
@@ -11,6 +11,8 @@
 /********************************** Includes *********************************/
 
 #include "config.h" // "Config" datatype
+#include <climits> // INT_MAX
+#include <vector> // std::vector...
 
 /********************************* Structures ********************************/
 
@@ -23,9 +25,10 @@ typedef struct Individual {
 	/**
 	 * @brief Vector denoting the selected features
 	 *
-	 * Values: Zeros or ones
+	 * Values: Zeros or ones. It contains "conf -> nFeatures" positions, so its size is only known at runtime
+	 * It takes one byte per feature even in wide sparse databases (256 KB with 262144 features), where an individual only selects a few features. Only the packed individuals store them as a list
 	 */
-	unsigned char chromosome[N_FEATURES];
+	std::vector<unsigned char> chromosome;
 
 
 	/**
@@ -36,6 +39,14 @@ typedef struct Individual {
 	float fitness[2];
 
 
+	/**
+	 * @brief Objectives of the individual before being normalized
+	 *
+	 * They are kept by "normalizeFitness", so the results file can be written without evaluating the individual again
+	 */
+	float rawFitness[2];
+
+
 	/**
 	 * @brief Crowding distance of the individual
 	 *
@@ -135,6 +146,115 @@ struct rankAndCrowdingCompare {
 	}
 };
 
+
+/**
+ * @brief Entry of a Pareto front. The individual is only referenced, so its chromosome is not copied until the fronts are stored
+ */
+typedef struct FrontSlot {
+
+
+	/**
+	 * @brief The referenced individual
+	 */
+	const Individual *ind;
+
+
+	/**
+	 * @brief The crowding distance of the individual inside its front
+	 */
+	float crowding;
+
+} FrontSlot;
+
+
+/**
+ * @brief Structure containing the Pareto fronts of a subpopulation, which are updated incrementally when individuals are inserted or removed
+ *
+ * Only two objectives are considered. Each front is kept sorted by the first objective (2D skyline), so the front of a new individual is found by binary search and only the affected fronts update their crowding distances
+ * The fronts only contain references to the individuals. Therefore, the individuals must not be modified or released while the fronts are in use
+ */
+typedef struct NonDominationFronts {
+
+
+	/**
+	 * @brief The referenced individuals of each front, sorted by the first objective. The rank of each individual is the index of its front
+	 */
+	std::vector< std::vector<FrontSlot> > fronts;
+
+
+	/**
+	 * @brief If the crowding distances of each front must be updated
+	 */
+	std::vector<bool> dirty;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor with parameters. The fronts are built in O(N log N)
+	 * @param subpop Current subpopulation
+	 * @param nIndividuals The number of individuals of the subpopulation
+	 * @return An object containing the Pareto fronts of the subpopulation
+	 */
+	NonDominationFronts(const Individual *const subpop, const int nIndividuals);
+
+
+	/**
+	 * @brief The constructor with parameters. The fronts are built in O(N log N) over individuals which are not contiguous in memory
+	 * @param individuals The individuals
+	 * @return An object containing the Pareto fronts of the individuals
+	 */
+	NonDominationFronts(std::vector<const Individual*> individuals);
+
+
+	/**
+	 * @brief Insert an individual. The individuals dominated by it are moved to the next fronts
+	 * @param ind The individual to be inserted. It is referenced, so it must remain unchanged until the fronts are stored
+	 */
+	void insert(const Individual &ind);
+
+
+	/**
+	 * @brief Remove the worst individual, that is, the individual with the lowest crowding distance of the last front
+	 * @return The reference to the removed individual
+	 */
+	const Individual* removeWorst();
+
+
+	/**
+	 * @brief Redirect the reference to an individual which has been moved to another place
+	 * @param ind The current reference to the individual
+	 * @param place The new place of the individual
+	 */
+	void relocate(const Individual *const ind, const Individual *const place);
+
+
+	/**
+	 * @brief Get the slots of the best individuals sorted by rank and crowding distance
+	 * @param nIndividuals The maximum number of slots
+	 * @param ranks The place where the rank of each slot will be stored
+	 * @return The sorted slots
+	 */
+	std::vector<FrontSlot*> sortedSlots(const int nIndividuals, std::vector<int> *const ranks);
+
+
+	/**
+	 * @brief Get the references to the individuals sorted by rank and crowding distance, without moving them
+	 * @return The sorted references
+	 */
+	std::vector<const Individual*> sortedReferences();
+
+
+	/**
+	 * @brief Store the best individuals sorted by rank and crowding distance. The referenced individuals which are already in the destination are swapped into their new positions and only the rest are copied
+	 * @param subpop The place where the individuals will be stored. It can overlap the referenced individuals
+	 * @param nIndividuals The maximum number of individuals to be stored. If some individuals are not stored, the fronts must not be used afterwards
+	 * @return The number of individuals in the front 0
+	 */
+	int store(Individual *const subpop, const int nIndividuals = INT_MAX);
+
+} NonDominationFronts;
+
 /********************************* Methods ********************************/
 
 /**
@@ -146,4 +266,84 @@ struct rankAndCrowdingCompare {
  */
 int nonDominationSort(Individual *const subpop, const int nIndividuals, const Config *const conf);
 
+
+/**
+ * @brief Gets the maximum size of the buffer which contains the packed individuals of several subpopulations
+ * @param nIndividuals The total number of individuals
+ * @param conf The structure with all configuration parameters
+ * @return The size in bytes
+ */
+size_t packedSize(const int nIndividuals, const Config *const conf);
+
+
+/**
+ * @brief Pack the first individuals of several subpopulations to be sent through the network. The chromosome of each individual is stored as a bitset or as a list with the indexes of the selected features, whichever is smaller
+ * @param subpops The subpopulations. Each one contains "conf -> familySize" individuals
+ * @param nSubpopulations The number of subpopulations
+ * @param nIndividuals The number of individuals packed from each subpopulation
+ * @param buffer The buffer where the individuals are packed. It must contain at least "packedSize(nSubpopulations * nIndividuals, conf)" bytes
+ * @param conf The structure with all configuration parameters
+ * @return The number of bytes used in the buffer
+ */
+int packSubpopulations(const Individual *const subpops, const int nSubpopulations, const int nIndividuals, unsigned char *const buffer, const Config *const conf);
+
+
+/**
+ * @brief Unpack the individuals packed by "packSubpopulations"
+ * @param buffer The buffer which contains the packed individuals
+ * @param subpops The place where the subpopulations will be stored. Each one contains "conf -> familySize" individuals
+ * @param conf The structure with all configuration parameters
+ * @return The total number of unpacked individuals
+ */
+int unpackSubpopulations(const unsigned char *const buffer, Individual *const subpops, const Config *const conf);
+
+
+/**
+ * @brief Checks that a buffer contains well-formed individuals packed by "packSubpopulations" without unpacking them
+ * @param buffer The buffer which contains the packed individuals
+ * @param nBytes The size of the buffer in bytes
+ * @param nSubpopulations The number of subpopulations which must be packed in the buffer
+ * @param nIndividuals The number of individuals which must be packed from each subpopulation
+ * @param conf The structure with all configuration parameters
+ * @return True if the buffer can be safely unpacked
+ */
+bool checkPackedSubpopulations(const unsigned char *const buffer, const size_t nBytes, const int nSubpopulations, const int nIndividuals, const Config *const conf);
+
+/**
+ * @brief Gets the size of an individual in the layout of the OpenCL kernels, whose chromosome has "N_FEATURES" positions
+ * @param conf The structure with all configuration parameters
+ * @return The size in bytes
+ */
+size_t deviceIndividualSize(const Config *const conf);
+
+
+/**
+ * @brief Copies the individuals into a buffer with the layout of the OpenCL kernels, so it can be written to the devices
+ * @param individuals The individuals
+ * @param nIndividuals The number of individuals
+ * @param buffer The buffer where the individuals are copied. It must contain at least "nIndividuals * deviceIndividualSize(conf)" bytes
+ * @param conf The structure with all configuration parameters
+ */
+void packDeviceIndividuals(const Individual *const individuals, const int nIndividuals, unsigned char *const buffer, const Config *const conf);
+
+
+/**
+ * @brief Copies the individuals read from the devices, which have the layout of the OpenCL kernels
+ * @param buffer The buffer which contains the individuals
+ * @param nIndividuals The number of individuals
+ * @param individuals The place where the individuals will be stored
+ * @param conf The structure with all configuration parameters
+ */
+void unpackDeviceIndividuals(const unsigned char *const buffer, const int nIndividuals, Individual *const individuals, const Config *const conf);
+
+
+/**
+ * @brief Copies only the fitness of the individuals read from the devices, which have the layout of the OpenCL kernels
+ * @param buffer The buffer which contains the individuals
+ * @param nIndividuals The number of individuals
+ * @param individuals The individuals whose fitness will be updated
+ * @param conf The structure with all configuration parameters
+ */
+void unpackDeviceFitness(const unsigned char *const buffer, const int nIndividuals, Individual *const individuals, const Config *const conf);
+
 #endif
\ No newline at end of file
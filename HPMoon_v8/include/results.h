@@ -0,0 +1,130 @@
+/**
+ * @file results.h
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief Header file for writing and reading the binary files with the final results of the genetic algorithm
+ */
+
+#ifndef RESULTS_H
+#define RESULTS_H
+
+/********************************* Includes *******************************/
+
+#include "individual.h" // Individual
+#include <stdint.h> // uint32_t, int32_t
+#include <vector> // std::vector...
+
+/******************************** Constants *******************************/
+
+const char *const RS_ERROR_FILE_OPEN = "Error: Could not open the results file";
+const char *const RS_ERROR_FILE_WRITE = "Error: Could not write the results file";
+const char *const RS_ERROR_FILE_FORMAT = "Error: The results file is corrupt or it has an unsupported version";
+const char *const RS_ERROR_READ_ARGUMENTS = "Error: The name of the results file is required";
+
+const uint32_t RS_MAGIC = 0x53524D48; // "HMRS" in little endian
+const uint32_t RS_VERSION = 1;
+
+/******************************** Structures ******************************/
+
+/**
+ * @brief Header of the results files
+ *
+ * After the header, each column is stored for all the individuals (first the final front 0 and then the world): the subpopulation, the rank, the crowding distance, the raw objectives, the normalized objectives, the offsets of the selected features of each individual and the selected features
+ */
+typedef struct ResultsHeader {
+
+
+	/**
+	 * @brief The identifier of the format and its version
+	 */
+	uint32_t magic;
+	uint32_t version;
+
+
+	/**
+	 * @brief The number of features of the database and the number of objectives
+	 */
+	uint32_t nFeatures;
+	uint32_t nObjectives;
+
+
+	/**
+	 * @brief The number of individuals of the final front 0 and of the world
+	 */
+	uint32_t nFront;
+	uint32_t nWorld;
+
+} ResultsHeader;
+
+
+/**
+ * @brief The content of a results file
+ */
+typedef struct Results {
+
+
+	/**
+	 * @brief The header of the file
+	 */
+	ResultsHeader header;
+
+
+	/**
+	 * @brief The subpopulation of each individual of the world, or -1 for the individuals of the final front 0
+	 */
+	std::vector<int32_t> subpopulation;
+
+
+	/**
+	 * @brief The rank of each individual inside its subpopulation (or inside the world for the final front 0)
+	 */
+	std::vector<int32_t> rank;
+
+
+	/**
+	 * @brief The crowding distance of each individual
+	 */
+	std::vector<float> crowding;
+
+
+	/**
+	 * @brief The objectives of the individuals, objective by objective. The raw ones are the values obtained by K-means and the normalized ones are the values used by the genetic algorithm
+	 */
+	std::vector<float> objectives;
+	std::vector<float> normalizedObjectives;
+
+
+	/**
+	 * @brief The selected features of the individual "i" are stored from "featureOffsets[i]" to "featureOffsets[i + 1]" in "features"
+	 */
+	std::vector<uint32_t> featureOffsets;
+	std::vector<uint32_t> features;
+
+} Results;
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Writes the final front 0 and, optionally, the world into the results file. The raw objectives are the ones kept by "normalizeFitness" and the file is written by a background thread, so the shutdown is not stalled
+ * @param front The final front 0
+ * @param nFront The number of individuals in the final front 0
+ * @param world The parents of all subpopulations, one subpopulation after another, or an empty vector if the world is not written
+ * @param conf The structure with all configuration parameters
+ */
+void writeResults(const Individual *const front, const int nFront, std::vector<Individual> world, const Config *const conf);
+
+
+/**
+ * @brief Waits until the results file has been completely written. It must be called before releasing the configuration
+ */
+void waitResults();
+
+
+/**
+ * @brief Reads a results file
+ * @param fileName The name of the results file
+ * @return The content of the file
+ */
+Results readResults(const char *const fileName);
+
+#endif
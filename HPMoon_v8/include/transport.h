@@ -0,0 +1,274 @@
+/**
+ * @file transport.h
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief Header file containing the transports used by the master, the workers and the peer migrations of the islands-based model
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+/********************************* Includes *******************************/
+
+#include <condition_variable> // std::condition_variable
+#include <deque> // std::deque
+#include <list> // std::list
+#include <mpi.h>
+#include <mutex> // std::mutex
+#include <vector> // std::vector...
+
+/******************************** Constants *******************************/
+
+const int TRANSPORT_ANY_SOURCE = -1;
+
+/******************************** Structures ******************************/
+
+/**
+ * @brief Receive posted by "Transport::irecv", which is completed by "Transport::test" or "Transport::wait"
+ */
+typedef struct TransportRequest {
+
+
+	/**
+	 * @brief The request of the receive when it is done by MPI
+	 */
+	MPI_Request request;
+
+
+	/**
+	 * @brief The buffer where the message will be stored, its size in bytes and the source process
+	 */
+	void *buffer;
+	int maxBytes;
+	int source;
+
+} TransportRequest;
+
+
+/**
+ * @brief Interface of the point-to-point messages exchanged between the master and the workers, and between the workers which directly exchange the migrants
+ */
+typedef struct Transport {
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief Sends a message without blocking. The data is copied, so the buffer can be reused immediately
+	 * @param data The message
+	 * @param nBytes The size of the message in bytes
+	 * @param dest The destination process
+	 * @param tag The tag of the message
+	 */
+	virtual void send(const void *const data, const int nBytes, const int dest, const int tag) = 0;
+
+
+	/**
+	 * @brief Receives the oldest message from the specified process. The messages of each process are received in order
+	 * @param buffer The buffer where the message will be stored
+	 * @param maxBytes The size of the buffer in bytes
+	 * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+	 * @param tag The tag of the received message
+	 * @return The source of the received message
+	 */
+	virtual int recv(void *const buffer, const int maxBytes, const int source, int *const tag) = 0;
+
+
+	/**
+	 * @brief Posts the receive of the next message from the specified process without blocking. The buffer can not be used until the receive is completed
+	 * @param buffer The buffer where the message will be stored
+	 * @param maxBytes The size of the buffer in bytes
+	 * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+	 * @param request The posted receive
+	 */
+	virtual void irecv(void *const buffer, const int maxBytes, const int source, TransportRequest *const request) = 0;
+
+
+	/**
+	 * @brief Checks if a posted receive has been completed without blocking
+	 * @param request The posted receive
+	 * @param tag The tag of the received message
+	 * @return The source of the received message, or -1 if the message has not arrived yet
+	 */
+	virtual int test(TransportRequest *const request, int *const tag) = 0;
+
+
+	/**
+	 * @brief Blocks until a posted receive is completed
+	 * @param request The posted receive
+	 * @param tag The tag of the received message
+	 * @return The source of the received message
+	 */
+	virtual int wait(TransportRequest *const request, int *const tag) = 0;
+
+
+	/**
+	 * @brief Checks if a message from the specified process has arrived without receiving it
+	 * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+	 * @param wait If it must block until a message arrives
+	 * @param nBytes The size in bytes of the oldest message of the returned process
+	 * @return The source of the message, or -1 if no message has arrived
+	 */
+	virtual int probe(const int source, const bool wait, int *const nBytes) = 0;
+
+
+	/**
+	 * @brief Waits until all the messages sent by this process have left their buffers
+	 */
+	virtual void flush() = 0;
+
+
+	/**
+	 * @brief Blocks until all processes have called it
+	 */
+	virtual void barrier() = 0;
+
+
+	/**
+	 * @brief The destructor
+	 */
+	virtual ~Transport() {}
+
+} Transport;
+
+
+/**
+ * @brief Transport over the MPI processes of "MPI_COMM_WORLD"
+ */
+typedef struct MPITransport : Transport {
+
+
+	/**
+	 * @brief The copies of the messages which have not been completely sent yet, and their requests
+	 */
+	std::list< std::vector<unsigned char> > pendingBuffers;
+	std::list<MPI_Request> pendingRequests;
+
+
+	/**
+	 * @brief Mutex protecting the pending messages, which are shared by all threads of the process
+	 */
+	std::mutex pendingMutex;
+
+
+	/********************************* Methods ********************************/
+
+	void send(const void *const data, const int nBytes, const int dest, const int tag);
+	int recv(void *const buffer, const int maxBytes, const int source, int *const tag);
+	void irecv(void *const buffer, const int maxBytes, const int source, TransportRequest *const request);
+	int test(TransportRequest *const request, int *const tag);
+	int wait(TransportRequest *const request, int *const tag);
+	int probe(const int source, const bool wait, int *const nBytes);
+	void flush();
+	void barrier();
+
+} MPITransport;
+
+
+/**
+ * @brief Message stored in the mailbox of a simulated process
+ */
+typedef struct LocalMessage {
+
+
+	/**
+	 * @brief The source process
+	 */
+	int source;
+
+
+	/**
+	 * @brief The tag of the message
+	 */
+	int tag;
+
+
+	/**
+	 * @brief The content of the message
+	 */
+	std::vector<unsigned char> data;
+
+} LocalMessage;
+
+
+/**
+ * @brief Mailboxes and barrier shared by the threads which simulate the processes of a cluster
+ */
+typedef struct LocalHub {
+
+
+	/**
+	 * @brief The pending messages of each simulated process, in arrival order
+	 */
+	std::vector< std::deque<LocalMessage> > mailboxes;
+
+
+	/**
+	 * @brief Mutex protecting the mailboxes and the barrier
+	 */
+	std::mutex mutex;
+
+
+	/**
+	 * @brief Condition notified when a message arrives or the barrier is released
+	 */
+	std::condition_variable arrived;
+
+
+	/**
+	 * @brief The number of processes waiting in the barrier and the number of times that the barrier has been released
+	 */
+	int nWaiting;
+	int barrierGeneration;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor with parameters
+	 * @param nProcesses The number of simulated processes
+	 */
+	LocalHub(const int nProcesses);
+
+} LocalHub;
+
+
+/**
+ * @brief Transport of a simulated process, whose messages are exchanged in memory with the rest of threads
+ */
+typedef struct LocalTransport : Transport {
+
+
+	/**
+	 * @brief The mailboxes shared by all simulated processes
+	 */
+	LocalHub *hub;
+
+
+	/**
+	 * @brief The identifier of the simulated process
+	 */
+	int rank;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor with parameters
+	 * @param hub The mailboxes shared by all simulated processes
+	 * @param rank The identifier of the simulated process
+	 */
+	LocalTransport(LocalHub *const hub, const int rank);
+
+	void send(const void *const data, const int nBytes, const int dest, const int tag);
+	int recv(void *const buffer, const int maxBytes, const int source, int *const tag);
+	void irecv(void *const buffer, const int maxBytes, const int source, TransportRequest *const request);
+	int test(TransportRequest *const request, int *const tag);
+	int wait(TransportRequest *const request, int *const tag);
+	int probe(const int source, const bool wait, int *const nBytes);
+	void flush();
+	void barrier();
+
+} LocalTransport;
+
+#endif
@@ -8,10 +8,15 @@
 /********************************* Includes *******************************/
 
 #include "ag.h"
+#include "checkpoint.h"
 #include "evaluation.h"
+#include "results.h"
 #include <algorithm> // std::max_element
+#include <deque> // std::deque
 #include <numeric> // std::iota
+#include <math.h> // sqrt
 #include <omp.h> // OpenMP
+#include <random> // std::mt19937
 #include <set> // std::set
 #include <string.h> // memcpy, memset
 
@@ -56,7 +61,7 @@ Individual* createSubpopulations(const Config *const conf) {
 	// Allocate memory for parents and children
 	Individual *subpops = new Individual[conf -> totalIndividuals];
 	for (int i = 0; i < conf -> totalIndividuals; ++i) {
-		memset(subpops[i].chromosome, 0, conf -> nFeatures * sizeof(unsigned char));
+		subpops[i].chromosome.assign(conf -> nFeatures, 0);
 		for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
 			subpops[i].fitness[obj] = 0.0f;
 		}
@@ -71,7 +76,7 @@ Individual* createSubpopulations(const Config *const conf) {
 
 			// Set the "1" value at most "conf -> maxFeatures" decision variables
 			for (int mf = 0; mf < conf -> maxFeatures; ++mf) {
-				int randomFeature = rand() % conf -> nFeatures;
+				int randomFeature = random() % conf -> nFeatures;
 				if (!(subpops[i].chromosome[randomFeature] & 1)) {
 					subpops[i].nSelFeatures += (subpops[i].chromosome[randomFeature] = 1);
 				}
@@ -97,7 +102,7 @@ int* getPool(const Config *const conf) {
 
 		// std::set guarantees unique elements in the insert function
 		for (int j = 0; j < conf -> tourSize; ++j) {
-			candidates.insert(rand() % conf -> subpopulationSize);
+			candidates.insert(random() % conf -> subpopulationSize);
 		}
 
 		// At this point, the individuals already are sorted by rank and crowding distance
@@ -114,41 +119,43 @@ int* getPool(const Config *const conf) {
  * @brief Perform binary crossover between two individuals (uniform crossover)
  * @param subpop Current subpopulation
  * @param pool Position of the selected individuals for the crossover
+ * @param children The place where the children will be stored. It must have room for "2 * nOperations" individuals
+ * @param nOperations The number of crossover or mutation operations to be performed
  * @param conf The structure with all configuration parameters
  * @return The number of generated children
  */
-int crossoverUniform(Individual *const subpop, const int *const pool, const Config *const conf) {
+int crossoverUniform(Individual *const subpop, const int *const pool, Individual *const children, const int nOperations, const Config *const conf) {
 
 	// Reset the children
-	for (int i = conf -> subpopulationSize; i < conf -> familySize; ++i) {
-		memset(subpop[i].chromosome, 0, conf -> nFeatures * sizeof(unsigned char));
+	for (int i = 0; i < nOperations << 1; ++i) {
+		children[i].chromosome.assign(conf -> nFeatures, 0);
 		for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
-			subpop[i].fitness[obj] = 0.0f;
+			children[i].fitness[obj] = 0.0f;
 		}
-		subpop[i].nSelFeatures = 0;
-		subpop[i].rank = -1;
-		subpop[i].crowding = 0.0f;
+		children[i].nSelFeatures = 0;
+		children[i].rank = -1;
+		children[i].crowding = 0.0f;
 	}
 
-	Individual *child = &(subpop[conf -> subpopulationSize]);
-	for (int i = 0; i < conf -> poolSize; ++i) {
+	Individual *child = children;
+	for (int i = 0; i < nOperations; ++i) {
 
 		// 75% probability perform crossover. Two childen are generated
-		Individual *parent1 = &(subpop[pool[rand() % conf -> poolSize]]);
-		if ((rand() / (float) RAND_MAX) < 0.75f) {
+		Individual *parent1 = &(subpop[pool[random() % conf -> poolSize]]);
+		if ((random() / RANDOM_MAX) < 0.75f) {
 
 			// Avoid repeated parents
-			Individual *parent2 = &(subpop[pool[rand() % conf -> poolSize]]);
+			Individual *parent2 = &(subpop[pool[random() % conf -> poolSize]]);
 			Individual *child2 = child + 1;
 			while (parent1 == parent2) {
-				parent2 = &(subpop[pool[rand() % conf -> poolSize]]);
+				parent2 = &(subpop[pool[random() % conf -> poolSize]]);
 			}
 
 			// Perform uniform crossover for each decision variable in the chromosome
 			for (int f = 0; f < conf -> nFeatures; ++f) {
 
 				// 50% probability perform copy the decision variable of the other parent
-				if ((parent1 -> chromosome[f] != parent2 -> chromosome[f]) && ((rand() / (float) RAND_MAX) < 0.5f)) {
+				if ((parent1 -> chromosome[f] != parent2 -> chromosome[f]) && ((random() / RANDOM_MAX) < 0.5f)) {
 					child -> nSelFeatures += (child -> chromosome[f] = parent2 -> chromosome[f]);
 					child2 -> nSelFeatures += (child2 -> chromosome[f] = parent1 -> chromosome[f]);
 				}
@@ -160,11 +167,11 @@ int crossoverUniform(Individual *const subpop, const int *const pool, const Conf
 
 			// At least one decision variable must be set to "1"
 			if (child -> nSelFeatures == 0) {
-				child -> chromosome[rand() % conf -> nFeatures] = child -> nSelFeatures = 1;
+				child -> chromosome[random() % conf -> nFeatures] = child -> nSelFeatures = 1;
 			}
 
 			if (child2 -> nSelFeatures == 0) {
-				child2 -> chromosome[rand() % conf -> nFeatures] = child2 -> nSelFeatures = 1;
+				child2 -> chromosome[random() % conf -> nFeatures] = child2 -> nSelFeatures = 1;
 			}
 			child += 2;
 		}
@@ -177,9 +184,9 @@ int crossoverUniform(Individual *const subpop, const int *const pool, const Conf
 			for (int f = 0; f < conf -> nFeatures; ++f) {
 
 				// 10% probability perform mutation (gen level)
-				float probability = (rand() / (float) RAND_MAX);
+				float probability = (random() / RANDOM_MAX);
 				if (probability < 0.1f) {
-					if ((rand() / (float) RAND_MAX) > 0.01f) {
+					if ((random() / RANDOM_MAX) > 0.01f) {
 						child -> chromosome[f] = 0;
 					}
 					else {
@@ -193,13 +200,37 @@ int crossoverUniform(Individual *const subpop, const int *const pool, const Conf
 
 			// At least one decision variable must be set to "1"
 			if (child -> nSelFeatures == 0) {
-				child -> chromosome[rand() % conf -> nFeatures] = child -> nSelFeatures = 1;
+				child -> chromosome[random() % conf -> nFeatures] = child -> nSelFeatures = 1;
 			}
 			++child;
 		}
 	}
 
-	return child - (subpop + conf -> subpopulationSize);
+	return child - children;
+}
+
+
+/**
+ * @brief Replace the worst individuals of a subpopulation by the migrants. The ranks and crowding distances are only updated in the fronts affected by the migrants
+ *
+ * Only the references to the individuals are moved while the fronts are updated. Then, the remaining parents are swapped into their new positions and only the migrants are copied
+ * @param subpop The subpopulation which receives the migrants
+ * @param migrants The references to the migrants. They must not be in the parents of the subpopulation
+ * @param nMigrants The number of migrants
+ * @param conf The structure with all configuration parameters
+ * @return The number of individuals in the front 0 of the subpopulation
+ */
+int insertMigrants(Individual *const subpop, const Individual *const *const migrants, const int nMigrants, const Config *const conf) {
+
+	NonDominationFronts fronts(subpop, conf -> subpopulationSize);
+	for (int i = 0; i < nMigrants; ++i) {
+		fronts.removeWorst();
+	}
+	for (int i = 0; i < nMigrants; ++i) {
+		fronts.insert(*migrants[i]);
+	}
+
+	return fronts.store(subpop);
 }
 
 
@@ -213,6 +244,9 @@ int crossoverUniform(Individual *const subpop, const int *const pool, const Conf
 void migration(Individual *const subpops, const int nSubpopulations, const int *const nIndsFronts0, const Config *const conf) {
 
 	// From subpopulations randomly choosen some individuals of the front 0 are copied to each subpopulation (the worst individuals are deleted)
+	// All migrants are choosen before replacing any individual, so the inserted individuals are not migrated again
+	// Only their references are stored until they are copied to the children of the receiving subpopulation, which are not used between epochs
+	std::vector< std::vector<const Individual*> > migrants(nSubpopulations);
 	for (int subpop = 0; subpop < nSubpopulations; ++subpop) {
 
 		// This vector contains the available subpopulations indexes which are randomly choosen for copy the individuals of the front 0
@@ -221,29 +255,250 @@ void migration(Individual *const subpops, const int nSubpopulations, const int *
 
 		// The current subpopulation will not copy its own individuals
 		randomIndex.erase(randomIndex.begin() + subpop);
-		std::random_shuffle(randomIndex.begin(), randomIndex.end());
+		std::random_shuffle(randomIndex.begin(), randomIndex.end(), [](const int n) { return random() % n; });
 
 		int maxCopy = conf -> subpopulationSize - nIndsFronts0[subpop];
-		Individual *ptrDest = subpops + (subpop * conf -> familySize) + conf -> subpopulationSize;
 		for (int subpop2 = 0; subpop2 < nSubpopulations - 1 && maxCopy > 0; ++subpop2) {
 			int toCopy = std::min(maxCopy, nIndsFronts0[randomIndex[subpop2]] >> 1);
-			Individual *ptrOrig = subpops + (randomIndex[subpop2] * conf -> familySize);
-			ptrDest -= toCopy;
-			memcpy(ptrDest, ptrOrig, toCopy * sizeof(Individual));
+			const Individual *ptrOrig = subpops + (randomIndex[subpop2] * conf -> familySize);
+			for (int i = 0; i < toCopy; ++i) {
+				migrants[subpop].push_back(ptrOrig + i);
+			}
 			maxCopy -= toCopy;
 		}
 	}
 
+	// Each migrant is copied once, before any subpopulation reorders its parents
 	#pragma omp parallel for
 	for (int sp = 0; sp < nSubpopulations; ++sp) {
-		int popIndex = sp * conf -> familySize;
+		Individual *const children = subpops + (sp * conf -> familySize) + conf -> subpopulationSize;
+		for (size_t m = 0; m < migrants[sp].size(); ++m) {
+			children[m] = *(migrants[sp][m]);
+			migrants[sp][m] = children + m;
+		}
+	}
 
-		// The crowding distance of the subpopulation is initialized again for the next nonDominationSort
-		for (int i = popIndex;  i < popIndex + conf -> subpopulationSize; ++i) {
-			subpops[i].crowding = 0.0f;
+	// The parents are reordered in place, so only the migrants are copied again
+	#pragma omp parallel for
+	for (int sp = 0; sp < nSubpopulations; ++sp) {
+		insertMigrants(subpops + (sp * conf -> familySize), migrants[sp].data(), migrants[sp].size(), conf);
+	}
+}
+
+
+/**
+ * @brief Gets the subpopulations which receive the migrants of a subpopulation when the workers directly exchange the migrants
+ * @param sp The index of the subpopulation
+ * @param gMig The current global migration
+ * @param seed The seed used by all processes to generate the random topology
+ * @param conf The structure with all configuration parameters
+ * @return The indexes of the neighbour subpopulations
+ */
+std::vector<int> getNeighbours(const int sp, const int gMig, const unsigned int seed, const Config *const conf) {
+
+	const int n = conf -> nSubpopulations;
+	std::vector<int> neighbours;
+
+	// Each subpopulation sends the migrants to the next one
+	if (conf -> migrationTopology == "ring") {
+		neighbours.push_back((sp + 1) % n);
+	}
+
+	// The subpopulations are placed in a grid as square as possible. Each one sends the migrants to its four neighbours
+	else if (conf -> migrationTopology == "torus") {
+		int rows = (int) sqrt((double) n);
+		while (n % rows != 0) {
+			--rows;
 		}
-		nonDominationSort(subpops + popIndex, conf -> subpopulationSize, conf);
+		int cols = n / rows;
+		int row = sp / cols;
+		int col = sp % cols;
+		int candidates[4] = {row * cols + (col + 1) % cols, row * cols + (col + cols - 1) % cols, ((row + 1) % rows) * cols + col, ((row + rows - 1) % rows) * cols + col};
+		for (int i = 0; i < 4; ++i) {
+			if (candidates[i] != sp && std::find(neighbours.begin(), neighbours.end(), candidates[i]) == neighbours.end()) {
+				neighbours.push_back(candidates[i]);
+			}
+		}
+	}
+
+	// A different random ring in each migration. All processes generate the same ring
+	else {
+		std::vector<int> ring(n);
+		std::iota(ring.begin(), ring.end(), 0);
+		std::shuffle(ring.begin(), ring.end(), std::mt19937(seed + gMig));
+		int pos = std::find(ring.begin(), ring.end(), sp) - ring.begin();
+		neighbours.push_back(ring[(pos + 1) % n]);
+	}
+
+	if (n == 1) {
+		neighbours.clear();
 	}
+
+	return neighbours;
+}
+
+
+/**
+ * @brief Evolve one subpopulation in asynchronous steady-state mode. Each device continuously takes a small batch of new children, evaluates it and inserts it into the subpopulation by replacing the worst individuals. Therefore, the devices never wait for each other at the end of a generation
+ *
+ * The batches are too small to normalize the fitness with their own statistics, which would not be comparable. Hence, the parents are evaluated first and the statistics of the whole island normalize the fitness of all its individuals
+ * @param subpop The subpopulation to be evolved
+ * @param nIndsFronts0 The number of individuals in the front 0 of the subpopulation
+ * @param devicesObject Structure containing the information of a device
+ * @param nDevices The number of devices that will evolve the subpopulation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void evolveSteady(Individual *const subpop, int *const nIndsFronts0, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+
+
+
+	/********** Statistics of the island ***********/
+
+	// The parents are evaluated again, because the immigrants were normalized with the statistics of other islands
+	float average[conf -> nObjectives];
+	float deviation[conf -> nObjectives];
+	evaluationDevices(subpop, conf -> subpopulationSize, devicesObject, nDevices, trDataBase, selInstances, conf);
+	getFitnessStatistics(subpop, conf -> subpopulationSize, average, deviation, conf);
+	normalizeFitness(subpop, conf -> subpopulationSize, average, deviation, conf);
+
+	// The same number of crossover operations as in the generational mode are performed
+	// The Pareto fronts are kept between insertions, so only the fronts affected by the new children are updated
+	// The individuals are not sorted until the end of the epoch. The tournaments use the positions of the individuals in the ranking of the fronts
+	int remainingOps = conf -> nGenerations * conf -> poolSize;
+	NonDominationFronts fronts(subpop, conf -> subpopulationSize);
+	std::vector<const Individual*> ranking = fronts.sortedReferences();
+	omp_lock_t subpopLock;
+	omp_init_lock(&subpopLock);
+
+	#pragma omp parallel num_threads(nDevices)
+	{
+		CLDevice *const device = &devicesObject[omp_get_thread_num()];
+
+		// Each device takes as many operations as individuals it evaluates at once
+		const int batchOps = std::max(1, std::min(device -> computeUnits, conf -> poolSize));
+		Individual *children = new Individual[batchOps << 1];
+		int nChildren;
+
+		do {
+
+
+			/********** Fill the mating pool and perform crossover with the current subpopulation ***********/
+
+			nChildren = 0;
+			omp_set_lock(&subpopLock);
+			int nOps = std::min(remainingOps, batchOps);
+			remainingOps -= nOps;
+			if (nOps > 0) {
+				int *const pool = getPool(conf);
+				for (int i = 0; i < conf -> poolSize; ++i) {
+					pool[i] = ranking[pool[i]] - subpop;
+				}
+				nChildren = crossoverUniform(subpop, pool, children, nOps, conf);
+				delete[] pool;
+			}
+			omp_unset_lock(&subpopLock);
+
+			if (nChildren > 0) {
+
+
+				/********** Multi-objective individuals evaluation over the own device ***********/
+
+				evaluationDevices(children, nChildren, device, 1, trDataBase, selInstances, conf);
+				normalizeFitness(children, nChildren, average, deviation, conf);
+
+
+				/********** Incremental replacement of the worst individuals ***********/
+
+				omp_set_lock(&subpopLock);
+				for (int i = 0; i < nChildren; ++i) {
+					fronts.insert(children[i]);
+				}
+
+				// The removed parents leave their places to the surviving children, which are swapped into them. Hence, the parents keep being the first individuals of the subpopulation
+				std::vector<bool> survivors(nChildren, true);
+				std::vector<int> freePlaces;
+				for (int i = 0; i < nChildren; ++i) {
+					const Individual *removed = fronts.removeWorst();
+					if (removed >= children && removed < children + nChildren) {
+						survivors[removed - children] = false;
+					}
+					else {
+						freePlaces.push_back(removed - subpop);
+					}
+				}
+				for (int i = 0, nFree = 0; i < nChildren; ++i) {
+					if (survivors[i]) {
+						Individual *const place = subpop + freePlaces[nFree++];
+						std::swap(*place, children[i]);
+						fronts.relocate(children + i, place);
+					}
+				}
+				ranking = fronts.sortedReferences();
+				omp_unset_lock(&subpopLock);
+			}
+		} while (nChildren > 0);
+
+		// Local resources used are released
+		delete[] children;
+	}
+
+	// The subpopulation is sorted once, at the end of the epoch
+	omp_destroy_lock(&subpopLock);
+	nIndsFronts0[0] = fronts.store(subpop);
+}
+
+
+/**
+ * @brief Evolve one subpopulation on a single GPU without leaving the device. Tournament, crossover, mutation, evaluation, normalization and survivors selection are executed as kernels, so the subpopulation is only transferred at the beginning and at the end of the generations
+ * @param subpop The subpopulation to be evolved
+ * @param nIndsFronts0 The number of individuals in the front 0 of the subpopulation
+ * @param device Structure containing the information of the GPU device
+ * @param conf The structure with all configuration parameters
+ */
+void evolveResident(Individual *const subpop, int *const nIndsFronts0, CLDevice *const device, const Config *const conf) {
+
+	// The command queue is out of order, so each command waits for the previous one
+	// The individuals are transferred with the layout of the kernels
+	cl_event event;
+	std::vector<unsigned char> deviceSubpop(conf -> subpopulationSize * deviceIndividualSize(conf));
+	packDeviceIndividuals(subpop, conf -> subpopulationSize, deviceSubpop.data(), conf);
+	check(clEnqueueWriteBuffer(device -> commandQueue, device -> objSubpopulations, CL_FALSE, 0, deviceSubpop.size(), deviceSubpop.data(), 0, NULL, &event) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_INDIVIDUALS);
+
+	// The children are only known by the device, so all the columns of the training database are streamed
+	std::vector<cl_int> allColumns(conf -> nFeatures);
+	std::iota(allColumns.begin(), allColumns.end(), 0);
+	setColumns(device, allColumns, conf, NULL);
+
+	// Only the children are evaluated. The unused children are skipped by the kernel
+	int begin = conf -> subpopulationSize;
+	int end = conf -> familySize;
+	check(clSetKernelArg(device -> kernel, 3, sizeof(int), &begin) != CL_SUCCESS, "%s\n", EV_ERROR_KERNEL_ARGUMENT4);
+	check(clSetKernelArg(device -> kernel, 4, sizeof(int), &end) != CL_SUCCESS, "%s\n", EV_ERROR_KERNEL_ARGUMENT5);
+
+	// The genetic operators are executed by a single work-group
+	cl_kernel kernels[4] = {device -> kernelCrossover, device -> kernel, device -> kernelNormalize, device -> kernelSurvivors};
+	size_t *wiGlobal[4] = {&(device -> wiLocal), &(device -> wiGlobal), &(device -> wiLocal), &(device -> wiLocal)};
+
+	for (int g = 0; g < conf -> nGenerations; ++g) {
+		cl_uint seed = (cl_uint) random();
+		check(clSetKernelArg(device -> kernelCrossover, 2, sizeof(cl_uint), &seed) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT_RESIDENT);
+		for (int k = 0; k < 4; ++k) {
+			cl_event kernelEvent;
+			check(clEnqueueNDRangeKernel(device -> commandQueue, kernels[k], 1, NULL, wiGlobal[k], &(device -> wiLocal), 1, &event, &kernelEvent) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_KERNEL);
+			clReleaseEvent(event);
+			event = kernelEvent;
+		}
+	}
+
+	// The parents are sorted by rank and crowding distance on the device
+	check(clEnqueueReadBuffer(device -> commandQueue, device -> objSubpopulations, CL_TRUE, 0, deviceSubpop.size(), deviceSubpop.data(), 1, &event, NULL) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_READING);
+	unpackDeviceIndividuals(deviceSubpop.data(), conf -> subpopulationSize, subpop, conf);
+	if (conf -> nGenerations > 0) {
+		check(clEnqueueReadBuffer(device -> commandQueue, device -> objNIndsFront0, CL_TRUE, 0, sizeof(int), nIndsFronts0, 1, &event, NULL) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_READING);
+	}
+	clReleaseEvent(event);
 }
 
 
@@ -263,6 +518,13 @@ void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const d
 	/********** Multi-objective individuals evaluation over all subpopulations ***********/
 
 	int nDevices = (omp_get_num_threads() > 1) ? 1 : conf -> nDevices;
+
+	// The steady-state mode always evaluates the parents by itself
+	if (conf -> steadyState) {
+		evolveSteady(subpop, nIndsFronts0, devicesObject, nDevices, trDataBase, selInstances, conf);
+		return;
+	}
+
 	if (initialize) {
 		evaluation(subpop, conf -> subpopulationSize, devicesObject, nDevices, trDataBase, selInstances, conf);
 
@@ -275,13 +537,18 @@ void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const d
 
 	/********** Start the evolution process ***********/
 
+	if (conf -> deviceResident && nDevices == 1 && devicesObject -> deviceType == CL_DEVICE_TYPE_GPU) {
+		evolveResident(subpop, nIndsFronts0, devicesObject, conf);
+		return;
+	}
+
 	for (int g = 0; g < conf -> nGenerations; ++g) {
 
 
 		/********** Fill the mating pool and perform crossover ***********/
 
 		const int *const pool = getPool(conf);
-		int nChildren = crossoverUniform(subpop, pool, conf);
+		int nChildren = crossoverUniform(subpop, pool, subpop + conf -> subpopulationSize, conf -> poolSize, conf);
 
 		// Local resources used are released
 		delete[] pool;
@@ -306,146 +573,563 @@ void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const d
 }
 
 
+/**
+ * @brief Evolve all subpopulations at the same time. In each generation, the children of all subpopulations are evaluated in a single batch, so the devices always have enough work even with many small subpopulations
+ * @param subpops The subpopulations to be evolved
+ * @param nSubpopulations The number of subpopulations
+ * @param nIndsFronts0 The number of individuals in the front 0 of each subpopulation
+ * @param devicesObject Structure containing the information of a device
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ * @param initialize If the subpopulations must be initialized or not
+ */
+void evolveIslands(Individual *const subpops, const int nSubpopulations, int *const nIndsFronts0, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, const Config *const conf, const bool initialize) {
+
+
+	/********** Multi-objective individuals evaluation over all subpopulations ***********/
+
+	int nIndividuals[nSubpopulations];
+	if (initialize) {
+		std::fill(nIndividuals, nIndividuals + nSubpopulations, conf -> subpopulationSize);
+		evaluationIslands(subpops, nSubpopulations, 0, nIndividuals, devicesObject, conf -> nDevices, trDataBase, selInstances, conf);
+
+
+		/********** Sort each subpopulation with the "Non-Domination-Sort" method ***********/
+
+		#pragma omp parallel for
+		for (int sp = 0; sp < nSubpopulations; ++sp) {
+			nIndsFronts0[sp] = nonDominationSort(subpops + (sp * conf -> familySize), conf -> subpopulationSize, conf);
+		}
+	}
+
+
+	/********** Start the evolution process ***********/
+
+	for (int g = 0; g < conf -> nGenerations; ++g) {
+
+
+		/********** Fill the mating pool and perform crossover in each subpopulation ***********/
+
+		for (int sp = 0; sp < nSubpopulations; ++sp) {
+			Individual *const subpop = subpops + (sp * conf -> familySize);
+			const int *const pool = getPool(conf);
+			nIndividuals[sp] = crossoverUniform(subpop, pool, subpop + conf -> subpopulationSize, conf -> poolSize, conf);
+
+			// Local resources used are released
+			delete[] pool;
+		}
+
+
+		/********** Multi-objective individuals evaluation over all subpopulations in a single batch ***********/
+
+		evaluationIslands(subpops, nSubpopulations, conf -> subpopulationSize, nIndividuals, devicesObject, conf -> nDevices, trDataBase, selInstances, conf);
+
+
+		/********** Replace each subpopulation ***********/
+
+		#pragma omp parallel for
+		for (int sp = 0; sp < nSubpopulations; ++sp) {
+			Individual *const subpop = subpops + (sp * conf -> familySize);
+
+			// The crowding distance of the parents is initialized again for the next nonDominationSort
+			for (int i = 0;  i < conf -> subpopulationSize; ++i) {
+				subpop[i].crowding = 0.0f;
+			}
+			nIndsFronts0[sp] = nonDominationSort(subpop, conf -> subpopulationSize + nIndividuals[sp], conf);
+		}
+	}
+}
+
+
+/**
+ * @brief Evolve the subpopulations owned by a worker when the workers directly exchange the migrants. After each migration the best individuals of the front 0 are sent to the neighbour subpopulations with non-blocking communications, and the migrants already received are inserted before the next generations. Therefore, the workers never wait for each other or for the master
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param transport The transport used to receive the subpopulations from the master and to exchange the migrants
+ * @param conf The structure with all configuration parameters
+ */
+void evolvePeers(CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, Transport *const transport, const Config *const conf) {
+
+
+	/********** Get the subpopulations owned by this worker ***********/
+
+	// The last value is the seed of the random topology
+	int tag;
+	int owners[conf -> nSubpopulations + 1];
+	transport -> recv(owners, sizeof(owners), 0, &tag);
+	unsigned int seed = owners[conf -> nSubpopulations];
+
+	std::vector<int> owned;
+	std::vector<int> localIndex(conf -> nSubpopulations, -1);
+	for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+		if (owners[sp] == conf -> mpiRank) {
+			localIndex[sp] = owned.size();
+			owned.push_back(sp);
+		}
+	}
+
+	int nOwned = owned.size();
+	Individual *subpops = new Individual[nOwned * conf -> familySize];
+	std::vector<int> nIndsFronts0(nOwned);
+	std::vector<unsigned char> buffer(packedSize(conf -> subpopulationSize, conf));
+	for (int i = 0; i < nOwned; ++i) {
+		transport -> recv(buffer.data(), buffer.size(), 0, &tag);
+		unpackSubpopulations(buffer.data(), subpops + (i * conf -> familySize), conf);
+	}
+
+	// The number of messages with migrants that other workers will send to this worker
+	int pendingMessages = 0;
+	for (int gMig = 0; gMig < conf -> nGlobalMigrations - 1; ++gMig) {
+		for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+			if (owners[sp] != conf -> mpiRank) {
+				std::vector<int> neighbours = getNeighbours(sp, gMig, seed, conf);
+				for (size_t n = 0; n < neighbours.size(); ++n) {
+					pendingMessages += (owners[neighbours[n]] == conf -> mpiRank);
+				}
+			}
+		}
+	}
+
+
+	/********** Evolution and non-blocking exchange of migrants ***********/
+
+	// The migrants of each subpopulation are stored until it starts the next generations
+	// The transport keeps a copy of the messages sent, so the send buffer can be reused
+	std::vector< std::vector<Individual> > inbox(nOwned);
+	std::vector<unsigned char> sendBuffer;
+
+	// The messages with migrants are received in the inbox. If "wait" is false, only the messages already arrived are received
+	// The master does not send anything else, so every message comes from another worker
+	auto receiveMigrants = [&](const bool wait) {
+		int nBytes, source;
+		while (pendingMessages > 0 && (source = transport -> probe(TRANSPORT_ANY_SOURCE, wait, &nBytes)) >= 0) {
+			int dest;
+			std::vector<unsigned char> packed(nBytes);
+			transport -> recv(packed.data(), nBytes, source, &dest);
+
+			// The number of migrants is known after unpacking them. Therefore, the inbox has room for the maximum number
+			std::vector<Individual> &migrants = inbox[localIndex[dest]];
+			size_t nPrevious = migrants.size();
+			migrants.resize(nPrevious + conf -> subpopulationSize);
+			migrants.resize(nPrevious + unpackSubpopulations(packed.data(), migrants.data() + nPrevious, conf));
+			--pendingMessages;
+		}
+	};
+
+	omp_set_nested(1);
+	int nThreads = std::max(1, std::min(conf -> nDevices, nOwned));
+	for (int gMig = 0; gMig < conf -> nGlobalMigrations; ++gMig) {
+
+		#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 1)
+		for (int i = 0; i < nOwned; ++i) {
+			Individual *const subpop = subpops + (i * conf -> familySize);
+
+			// The migrants already received are inserted without waiting for the rest
+			// The subpopulation has no fronts until its first generations, so its inbox is kept until the next migration
+			std::vector<Individual> migrants;
+			#pragma omp critical (migrants)
+			{
+				receiveMigrants(false);
+				if (gMig > 0) {
+					migrants.swap(inbox[i]);
+				}
+			}
+			int nMigrants = std::min((int) migrants.size(), conf -> subpopulationSize - nIndsFronts0[i]);
+			if (nMigrants > 0) {
+				std::vector<const Individual*> references(nMigrants);
+				for (int m = 0; m < nMigrants; ++m) {
+					references[m] = &migrants[m];
+				}
+				nIndsFronts0[i] = insertMigrants(subpop, references.data(), nMigrants, conf);
+			}
+
+			evolve(subpop, &nIndsFronts0[i], &devicesObject[omp_get_thread_num()], trDataBase, selInstances, conf, gMig == 0);
+
+			// The best half of the front 0 is sent to the neighbour subpopulations
+			if (gMig != conf -> nGlobalMigrations - 1) {
+				std::vector<int> neighbours = getNeighbours(owned[i], gMig, seed, conf);
+				nMigrants = nIndsFronts0[i] >> 1;
+				#pragma omp critical (migrants)
+				for (size_t n = 0; n < neighbours.size(); ++n) {
+					int dest = neighbours[n];
+					if (owners[dest] == conf -> mpiRank) {
+						inbox[localIndex[dest]].insert(inbox[localIndex[dest]].end(), subpop, subpop + nMigrants);
+					}
+					else {
+						sendBuffer.resize(packedSize(nMigrants, conf));
+						int nBytes = packSubpopulations(subpop, 1, nMigrants, sendBuffer.data(), conf);
+						transport -> send(sendBuffer.data(), nBytes, owners[dest], dest);
+					}
+				}
+			}
+		}
+	}
+
+	// The migrants which arrive after the last generations are discarded
+	receiveMigrants(true);
+
+
+	/********** The final subpopulations are sent to the master in order ***********/
+
+	for (int i = 0; i < nOwned; ++i) {
+		int nBytes = packSubpopulations(subpops + (i * conf -> familySize), 1, conf -> subpopulationSize, buffer.data(), conf);
+		transport -> send(buffer.data(), nBytes, 0, nIndsFronts0[i]);
+	}
+
+	// Local resources used are released
+	delete[] subpops;
+}
+
+
 /**
  * @brief Island-based genetic algorithm model
  * @param subpops The initial subpopulations
  * @param devicesObject Structure containing the information of a device
  * @param trDataBase The training database which will contain the instances and the features
+ * @param trStream The growing training database of the streaming mode, or NULL
  * @param selInstances The instances choosen as initial centroids
- * @param conf The structure with all configuration parameters
+ * @param transport The transport used to exchange the subpopulations between the master and the workers, and the migrants between the workers
+ * @param conf The structure with all configuration parameters. The number of training instances grows in the streaming mode
  */
-void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, DataBaseStream *const trStream, const int *const selInstances, Transport *const transport, Config *const conf) {
+
 
+	/********** Communication variables ***********/
 
-	/********** MPI variables ***********/
+	int tag;
 
-	MPI::Status status;
-	int array_of_blocklengths[3] = {conf -> nFeatures, conf -> nObjectives + 1, 2};
-	MPI::Datatype array_of_types[3] = {MPI::UNSIGNED_CHAR, MPI::FLOAT, MPI::INT};
+	// Only the parents of the subpopulations are sent, packed by "packSubpopulations"
+	std::vector<unsigned char> buffer(packedSize(conf -> subpopulationSize, conf));
 
-	// The "Individual" datatype must be converted to a MPI datatype and commit it
-	MPI::Aint array_of_displacement[3] = {offsetof(Individual, chromosome), offsetof(Individual, fitness), offsetof(Individual, rank)};
-	MPI::Datatype Individual_MPI_type = MPI::Datatype::Create_struct(3, array_of_blocklengths, array_of_displacement, array_of_types);
-	Individual_MPI_type.Commit();
+	// The workers directly exchange the migrants through the transport
+	bool peerMigration = (conf -> mpiSize > 1 && conf -> migrationTopology != "master");
 
 
 	/******* Measure and start the master-worker algorithm *******/
 
-	MPI::COMM_WORLD.Barrier();
+	transport -> barrier();
 
 	// Master
 	if (conf -> mpiRank == 0) {
 		double timeStart = omp_get_wtime();
-		MPI::Request requests[conf -> mpiSize - 1];
 		int nIndsFronts0[conf -> nSubpopulations];
 		int finalFront0;
 
+		// The interrupted execution continues from the next migration stored in the latest checkpoint
+		int firstMigration = (conf -> resume) ? readCheckpoint(subpops, nIndsFronts0, conf) : 0;
+
 		// I work alone
 		if (conf -> mpiSize == 1) {
 			omp_set_nested(1);
 			int nThreads = std::min(conf -> nDevices, conf -> nSubpopulations);
-			for (int gMig = 0; gMig < conf -> nGlobalMigrations; ++gMig) {
 
-				#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 1)
-				for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
-					int popIndex = sp * conf -> familySize;
-					evolve(subpops + popIndex, &nIndsFronts0[sp], &devicesObject[omp_get_thread_num()], trDataBase, selInstances, conf, gMig == 0);
+			// The parents are evaluated in the first migration. In the streaming mode, they are evaluated again when the database grows, and also when the execution is resumed, because the stored fitness may come from fewer instances
+			bool evaluateParents = (firstMigration == 0 || trStream != NULL);
+			for (int gMig = firstMigration; gMig < conf -> nGlobalMigrations; ++gMig) {
+
+				// The children of all subpopulations are evaluated in a single batch by all devices
+				if (conf -> batchIslands) {
+					evolveIslands(subpops, conf -> nSubpopulations, nIndsFronts0, devicesObject, trDataBase, selInstances, conf, evaluateParents);
+				}
+				else {
+					#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 1)
+					for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+						int popIndex = sp * conf -> familySize;
+						evolve(subpops + popIndex, &nIndsFronts0[sp], &devicesObject[omp_get_thread_num()], trDataBase, selInstances, conf, evaluateParents);
+					}
 				}
 
-				// Migration process between subpopulations
-				if (gMig != conf -> nGlobalMigrations - 1 && conf -> nSubpopulations > 1) {
-					migration(subpops, conf -> nSubpopulations, nIndsFronts0, conf);
+				// Migration process between subpopulations and checkpoint of the resulting state
+				if (gMig != conf -> nGlobalMigrations - 1) {
+					if (conf -> nSubpopulations > 1) {
+						migration(subpops, conf -> nSubpopulations, nIndsFronts0, conf);
+					}
+					if (!conf -> checkpointFileName.empty()) {
+						writeCheckpoint(subpops, nIndsFronts0, selInstances, gMig + 1, conf);
+					}
+
+					// The instances appended to the database are taken before the next migration
+					evaluateParents = (trStream != NULL && appendDataBaseStream(trStream, conf) > 0);
 				}
 			}
 		}
 
 		// I need to distribute
 		else {
+			omp_set_nested(1);
 
 			// The master receives the number of subpopulations that each worker can process
-			int workerCapacities[conf -> mpiSize - 1];
+			// The first position is for the master, which only evolves subpopulations if it is configured as a worker too
+			int workerCapacities[conf -> mpiSize];
+			workerCapacities[0] = (conf -> masterWorker) ? conf -> nDevices : 0;
 			for (int p = 1; p < conf -> mpiSize; ++p) {
-				requests[p - 1] = MPI::COMM_WORLD.Irecv(&workerCapacities[p - 1], 1, MPI::INT, p, MPI::ANY_TAG);
+				transport -> recv(&workerCapacities[p], sizeof(int), p, &tag);
 			}
 
-			MPI::Request::Waitall(conf -> mpiSize - 1, requests);
+			// Until it is measured, the throughput of each worker is estimated by the number of subpopulations that it can process
+			std::vector<double> throughputs(workerCapacities, workerCapacities + conf -> mpiSize);
+
+
+			/********** The subpopulations stay in the workers, which directly exchange the migrants  ***********/
+
+			if (peerMigration) {
+
+				// Each worker owns a number of subpopulations proportional to the number of subpopulations that it can process
+				// The last value is the seed of the random topology
+				int owners[conf -> nSubpopulations + 1];
+				std::vector<int> nOwned(conf -> mpiSize, 0);
+				for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+					int best = 1;
+					for (int p = 2; p < conf -> mpiSize; ++p) {
+						if ((nOwned[p] + 1) * workerCapacities[best] < (nOwned[best] + 1) * workerCapacities[p]) {
+							best = p;
+						}
+					}
+					owners[sp] = best;
+					++nOwned[best];
+				}
+				owners[conf -> nSubpopulations] = random();
+
+				// Each worker receives the owners before its subpopulations, since the messages of each process are received in order
+				for (int p = 1; p < conf -> mpiSize; ++p) {
+					transport -> send(owners, sizeof(owners), p, INITIALIZE);
+				}
+				for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+					int nBytes = packSubpopulations(subpops + (sp * conf -> familySize), 1, conf -> subpopulationSize, buffer.data(), conf);
+					transport -> send(buffer.data(), nBytes, owners[sp], INITIALIZE);
+				}
+
+				// Only the final subpopulations are received. Each worker sends them in order
+				for (int p = 1; p < conf -> mpiSize; ++p) {
+					for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+						if (owners[sp] == p) {
+							transport -> recv(buffer.data(), buffer.size(), p, &nIndsFronts0[sp]);
+							unpackSubpopulations(buffer.data(), subpops + (sp * conf -> familySize), conf);
+						}
+					}
+				}
+			}
 
 
 			/********** In each migration the individuals are exchanged between subpopulations of different nodes  ***********/
 
-			for (int gMig = 0; gMig < conf -> nGlobalMigrations; ++gMig) {
+			for (int gMig = firstMigration; gMig < conf -> nGlobalMigrations && !peerMigration; ++gMig) {
 
-				// Send some work to the workers
-				int nextWork = 0;
-				int sent = 0;
+				// Each worker gets a queue of consecutive subpopulations proportional to its measured throughput
 				int mpiTag = (gMig == 0) ? INITIALIZE : IGNORE_VALUE;
-				for (int p = 1; p < conf -> mpiSize && nextWork < conf -> nSubpopulations; ++p) {
-						int finallyWork = std::min(workerCapacities[p - 1], conf -> nSubpopulations - nextWork);
-						int popIndex = nextWork * conf -> familySize;
-						requests[p - 1] = MPI::COMM_WORLD.Isend(subpops + popIndex, finallyWork * conf -> familySize, Individual_MPI_type, p, mpiTag);
-						nextWork += finallyWork;
-						++sent;
+				std::vector< std::deque<int> > queues(conf -> mpiSize);
+				std::vector<int> nQueued(conf -> mpiSize, 0);
+				for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+					int best = -1;
+					for (int p = 0; p < conf -> mpiSize; ++p) {
+						if (throughputs[p] > 0 && (best < 0 || (nQueued[p] + 1) / throughputs[p] < (nQueued[best] + 1) / throughputs[best])) {
+							best = p;
+						}
+					}
+
+					// If no process has a positive throughput, the subpopulations are dealt round-robin among the workers. The queues of the workers which can not process them are emptied by stealing
+					if (best < 0) {
+						best = 1 + (sp % (conf -> mpiSize - 1));
+					}
+					++nQueued[best];
 				}
-				MPI::Request::Waitall(sent, requests);
-
-				// Dynamically distribute the subpopulations
-				int receivedPtr = 0;
-				while (nextWork < conf -> nSubpopulations) {
-					MPI::COMM_WORLD.Recv(subpops + (receivedPtr * conf -> familySize), conf -> familySize, Individual_MPI_type, MPI::ANY_SOURCE, MPI::ANY_TAG, status);
-					int popIndex = nextWork * conf -> familySize;
-					MPI::COMM_WORLD.Send(subpops + popIndex, conf -> familySize, Individual_MPI_type, status.Get_source(), mpiTag);
-					nIndsFronts0[receivedPtr] = status.Get_tag();
-					++receivedPtr;
-					++nextWork;
+				for (int p = 0, sp = 0; p < conf -> mpiSize; ++p) {
+					for (int i = 0; i < nQueued[p]; ++i, ++sp) {
+						queues[p].push_back(sp);
+					}
 				}
 
-				// Receive the remaining work
-				while (receivedPtr < conf -> nSubpopulations) {
-					MPI::COMM_WORLD.Recv(subpops + (receivedPtr * conf -> familySize), conf -> familySize, Individual_MPI_type, MPI::ANY_SOURCE, MPI::ANY_TAG, status);
-					MPI::COMM_WORLD.Send(NULL, 0, MPI::INT, status.Get_source(), FINISH);
-					nIndsFronts0[receivedPtr] = status.Get_tag();
-					++receivedPtr;
+				// The next subpopulation for a worker: the front of its own queue or, if it is empty, the back of the queue which would take longer to finish
+				// It returns -1 if there is no more work. The master threads also take their work from here
+				auto takeWork = [&](const int p) {
+					int sp = -1;
+					#pragma omp critical (queues)
+					{
+						int victim = p;
+						for (int v = 0; v < conf -> mpiSize && queues[p].empty(); ++v) {
+							if (!queues[v].empty() && (queues[victim].empty() || queues[v].size() / throughputs[v] > queues[victim].size() / throughputs[victim])) {
+								victim = v;
+							}
+						}
+						if (!queues[victim].empty()) {
+							if (victim == p) {
+								sp = queues[victim].front();
+								queues[victim].pop_front();
+							}
+							else {
+								sp = queues[victim].back();
+								queues[victim].pop_back();
+							}
+						}
+					}
+					return sp;
+				};
+
+				// Send some work to the workers. Each worker thread evolves one subpopulation
+				// The slots of the subpopulations already sent receive the evolved ones
+				std::vector<int> nThreads(conf -> mpiSize, 0);
+				std::deque<int> freeSlots;
+				std::vector<unsigned char> packed;
+				for (int p = 1; p < conf -> mpiSize; ++p) {
+					int finallyWork = std::min(workerCapacities[p], nQueued[p]);
+					if (finallyWork > 0) {
+						int popIndex = queues[p].front() * conf -> familySize;
+						packed.resize(packedSize(finallyWork * conf -> subpopulationSize, conf));
+						int nBytes = packSubpopulations(subpops + popIndex, finallyWork, conf -> subpopulationSize, packed.data(), conf);
+						transport -> send(packed.data(), nBytes, p, mpiTag);
+						for (int i = 0; i < finallyWork; ++i) {
+							freeSlots.push_back(queues[p].front());
+							queues[p].pop_front();
+						}
+						nThreads[p] = finallyWork;
+					}
 				}
 
-				// Migration process between subpopulations of different nodes
-				if (gMig != conf -> nGlobalMigrations - 1 && conf -> nSubpopulations > 1) {
-					migration(subpops, conf -> nSubpopulations, nIndsFronts0, conf);
+				// The next subpopulation of a worker thread, or "FINISH" if there is no more work
+				// Each thread finishes when it receives "FINISH", so each worker receives as many "FINISH" as threads
+				std::vector<int> nFinish(conf -> mpiSize, 0);
+				packed.resize(std::max(packed.size(), buffer.size()));
+				auto sendNextWork = [&](const int p) {
+					int sp = takeWork(p);
+					if (sp >= 0) {
+						int nBytes = packSubpopulations(subpops + (sp * conf -> familySize), 1, conf -> subpopulationSize, packed.data(), conf);
+						transport -> send(packed.data(), nBytes, p, mpiTag);
+						freeSlots.push_back(sp);
+					}
+					else if (nFinish[p] < nThreads[p]) {
+						transport -> send(NULL, 0, p, FINISH);
+						++nFinish[p];
+					}
+				};
+
+				// Each worker thread prefetches its next subpopulation while it evolves the current one
+				for (int p = 1; p < conf -> mpiSize; ++p) {
+					for (int t = 0; t < nThreads[p]; ++t) {
+						sendNextWork(p);
+					}
+				}
+
+				// One thread of the master distributes the subpopulations while the rest evolve them over the local devices
+				// The local threads notify each evolved subpopulation to the master itself, so a single receive attends all of them
+				double timeEpoch = omp_get_wtime();
+				std::vector<int> nCompleted(conf -> mpiSize, 0);
+				std::vector<double> timeCompleted(conf -> mpiSize, 0.0);
+				int nLocalThreads = std::min(workerCapacities[0], conf -> nSubpopulations);
+				#pragma omp parallel num_threads(1 + nLocalThreads)
+				{
+					int threadID = omp_get_thread_num();
+
+					// Dynamically distribute the subpopulations. Each result is answered with the next prefetch
+					if (threadID == 0) {
+						for (int received = 0; received < conf -> nSubpopulations; ++received) {
+							int resultTag;
+							int p = transport -> recv(buffer.data(), buffer.size(), TRANSPORT_ANY_SOURCE, &resultTag);
+							if (p != 0) {
+								int slot = freeSlots.front();
+								freeSlots.pop_front();
+								unpackSubpopulations(buffer.data(), subpops + (slot * conf -> familySize), conf);
+								nIndsFronts0[slot] = resultTag;
+								sendNextWork(p);
+							}
+							++nCompleted[p];
+							timeCompleted[p] = omp_get_wtime() - timeEpoch;
+						}
+					}
+
+					// The local subpopulations are evolved in their own slots
+					else {
+						bool initialize = (gMig == 0);
+						for (int sp = takeWork(0); sp >= 0; sp = takeWork(0)) {
+							evolve(subpops + (sp * conf -> familySize), &nIndsFronts0[sp], &devicesObject[threadID - 1], trDataBase, selInstances, conf, initialize);
+							transport -> send(NULL, 0, 0, 0);
+						}
+					}
+				}
+				transport -> flush();
+
+				// The throughput of each worker (subpopulations per second) weights the queues of the next epoch
+				for (int p = 0; p < conf -> mpiSize; ++p) {
+					if (nCompleted[p] > 0) {
+						throughputs[p] = nCompleted[p] / std::max(timeCompleted[p], 1e-6);
+					}
+				}
+
+				// Migration process between subpopulations of different nodes and checkpoint of the resulting state
+				if (gMig != conf -> nGlobalMigrations - 1) {
+					if (conf -> nSubpopulations > 1) {
+						migration(subpops, conf -> nSubpopulations, nIndsFronts0, conf);
+					}
+					if (!conf -> checkpointFileName.empty()) {
+						writeCheckpoint(subpops, nIndsFronts0, selInstances, gMig + 1, conf);
+					}
 				}
 			}
 
 			// Notify to all workers that the work has finished
-			for (int p = 1; p < conf -> mpiSize; ++p) {
-				requests[p - 1] = MPI::COMM_WORLD.Isend(NULL, 0, MPI::INT, p, FINISH);
+			for (int p = 1; p < conf -> mpiSize && !peerMigration; ++p) {
+				transport -> send(NULL, 0, p, FINISH);
 			}
 		}
 
 
+		// The last checkpoint must be complete before finishing
+		waitCheckpoint();
+
+
 		/********** Recombination process ***********/
 
-		if (conf -> nSubpopulations > 1) {
+		// The parents of all subpopulations are kept for the results file before the recombination overwrites the first subpopulation
+		std::vector<Individual> world;
+		if (!conf -> resultsFileName.empty() && conf -> resultsWorld) {
 			for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
-				memcpy(subpops + (sp * conf -> subpopulationSize), subpops + (sp * conf -> familySize), conf -> subpopulationSize * sizeof(Individual));
+				world.insert(world.end(), subpops + (sp * conf -> familySize), subpops + (sp * conf -> familySize) + conf -> subpopulationSize);
 			}
+		}
 
-			// The crowding distance of the subpopulation is initialized again for the next nonDominationSort
-			#pragma omp parallel for
-			for (int i = 0;  i < conf -> worldSize; ++i) {
-				subpops[i].crowding = 0.0f;
+		if (conf -> nSubpopulations > 1) {
+
+			// The fronts of the world are built over the parents where they are, without compacting them
+			std::vector<const Individual*> parents;
+			parents.reserve(conf -> worldSize);
+			for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+				for (int i = 0; i < conf -> subpopulationSize; ++i) {
+					parents.push_back(subpops + (sp * conf -> familySize) + i);
+				}
 			}
-			finalFront0 = std::min(conf -> subpopulationSize, nonDominationSort(subpops, conf -> worldSize, conf));
+
+			// The best individuals are stored in the parents of the first subpopulation. Its own individuals are swapped and only the rest are copied
+			NonDominationFronts fronts(parents);
+			finalFront0 = std::min(conf -> subpopulationSize, fronts.store(subpops, conf -> subpopulationSize));
 		}
 		else {
 			finalFront0 = nIndsFronts0[0];
 		}
 
 		// All processes must reach this point in order to provide a real time measure
-		MPI::Request::Waitall(conf -> mpiSize - 1, requests);
-		MPI::COMM_WORLD.Barrier();
+		transport -> flush();
+		transport -> barrier();
 		fprintf(stdout, "%.10g\n", (omp_get_wtime() - timeStart) * 1000.0);
 
+		// The results file is written in background while the rest of outputs are generated
+		if (!conf -> resultsFileName.empty()) {
+			writeResults(subpops, finalFront0, std::move(world), conf);
+		}
+
 		// Get the hypervolume
 		fprintf(stdout, "%.6g\n", getHypervolume(subpops, finalFront0, conf));
 
+		// The fitness obtained over the quantized database is compared with the original one
+		if (conf -> trQuantize) {
+			reportQuantizationError(subpops, finalFront0, trDataBase, selInstances, conf);
+		}
+
+		// The fitness obtained on the devices is compared with the CPU one
+		if (conf -> verifyDevices && conf -> nDevices > 0) {
+			reportDevicesError(subpops, finalFront0, devicesObject, conf -> nDevices, trDataBase, selInstances, conf);
+		}
+
 		// Generation of the Gnuplot file for display the Pareto front
 		generateDataPlot(subpops, finalFront0, conf);
 		generateGnuplot(conf);
@@ -455,41 +1139,110 @@ void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *
 	else {
 
 		// The worker tells to the master how many subpopulations can be processed
-		MPI::COMM_WORLD.Isend(&(conf -> nDevices), 1, MPI::INT, 0, 0);
-		omp_set_nested(1);
-		subpops = new Individual[conf -> nDevices * conf -> familySize];
+		transport -> send(&(conf -> nDevices), sizeof(int), 0, 0);
 
-		// The worker receives as many subpopulations as number of devices at most
-		MPI::COMM_WORLD.Recv(subpops, conf -> nDevices * conf -> familySize, Individual_MPI_type, 0, MPI::ANY_TAG, status);
-
-		while (status.Get_tag() != FINISH) {
-			int nSubpopulations = status.Get_count(Individual_MPI_type) / conf -> familySize;
-			int EXIT = false;
+		// The subpopulations stay in the worker
+		if (peerMigration) {
+			evolvePeers(devicesObject, trDataBase, selInstances, transport, conf);
+		}
+		else {
+			omp_set_nested(1);
+			subpops = new Individual[conf -> nDevices * conf -> familySize];
+
+			// The worker receives as many subpopulations as number of devices at most
+			buffer.resize(packedSize(conf -> nDevices * conf -> subpopulationSize, conf));
+			transport -> recv(buffer.data(), buffer.size(), 0, &tag);
+
+			while (tag != FINISH) {
+				int nSubpopulations = unpackSubpopulations(buffer.data(), subpops, conf) / conf -> subpopulationSize;
+				int EXIT = false;
+
+				#pragma omp parallel num_threads(nSubpopulations)
+				{
+					int threadID = omp_get_thread_num();
+					int threadTag;
+					int nIndsFronts0;
+					int popIndex = threadID * conf -> familySize;
+					bool initialize = (tag == INITIALIZE);
+
+					// The master prefetches the next subpopulation of this thread while the current one is evolved
+					// Its receive is posted before evolving, so it arrives during the evolution into its own buffer
+					// The results are sent without waiting, since the transport keeps a copy of them
+					std::vector<unsigned char> sendBuffer(packedSize(conf -> subpopulationSize, conf));
+					std::vector<unsigned char> recvBuffer(sendBuffer.size());
+					TransportRequest recvRequest;
+					transport -> irecv(recvBuffer.data(), recvBuffer.size(), 0, &recvRequest);
+					while (true) {
+						evolve(subpops + popIndex, &nIndsFronts0, &devicesObject[threadID], trDataBase, selInstances, conf, initialize);
+
+						// The Worker sends to the master the subpopulations already evaluated
+						int nBytes = packSubpopulations(subpops + popIndex, 1, conf -> subpopulationSize, sendBuffer.data(), conf);
+						transport -> send(sendBuffer.data(), nBytes, 0, nIndsFronts0);
+
+						// The prefetched subpopulation is evolved next
+						transport -> wait(&recvRequest, &threadTag);
+						if (threadTag == FINISH) {
+							break;
+						}
+						unpackSubpopulations(recvBuffer.data(), subpops + popIndex, conf);
+						initialize = (threadTag == INITIALIZE);
+						transport -> irecv(recvBuffer.data(), recvBuffer.size(), 0, &recvRequest);
+					}
+				}
 
-			#pragma omp parallel num_threads(nSubpopulations)
-			{
-				int threadID = omp_get_thread_num();
-				MPI::Request request;
-				MPI::Status stat = status;
-				int nIndsFronts0;
-				int popIndex = threadID * conf -> familySize;
-				do {
-					evolve(subpops + popIndex, &nIndsFronts0, &devicesObject[threadID], trDataBase, selInstances, conf, stat.Get_tag() == INITIALIZE);
-
-					// The Worker sends to the master the subpopulations already evaluated and will request new work
-					request = MPI::COMM_WORLD.Isend(subpops + popIndex, conf -> familySize, Individual_MPI_type, 0, nIndsFronts0);
-					request.Wait();
-					MPI::COMM_WORLD.Recv(subpops + popIndex, conf -> familySize, Individual_MPI_type, 0, MPI::ANY_TAG, stat);
-				} while (stat.Get_tag() != FINISH);
+				transport -> recv(buffer.data(), buffer.size(), 0, &tag);
 			}
-
-			MPI::COMM_WORLD.Recv(subpops, conf -> nDevices * conf -> familySize, Individual_MPI_type, 0, MPI::ANY_TAG, status);
+			delete[] subpops;
 		}
 
 		// All process must reach this point in order to provide a real time measure
-		MPI::COMM_WORLD.Barrier();
+		transport -> flush();
+		transport -> barrier();
+	}
+}
+
+
+/**
+ * @brief Island-based genetic algorithm model over a simulated cluster. The master and the workers are threads of this process which exchange the subpopulations in memory
+ * @param subpops The initial subpopulations
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param transposedTrDataBase The transposed training database
+ * @param selInstances The instances choosen as initial centroids
+ * @param argc Number of arguments of the program, used to get the configuration of each simulated process
+ * @param argv Arguments of the program
+ * @param conf The structure with all configuration parameters
+ */
+void agIslandsSimulated(Individual *const subpops, const float *const trDataBase, const float *const transposedTrDataBase, const int *const selInstances, const int argc, const char **argv, const Config *const conf) {
+
+
+	/********** Each simulated process gets its configuration and devices as if it were an MPI process ***********/
+
+	int nProcesses = conf -> simWorkers + 1;
+	std::vector<Config*> confs(nProcesses);
+	std::vector<CLDevice*> devices(nProcesses, NULL);
+	for (int p = 0; p < nProcesses; ++p) {
+		confs[p] = new Config(argc, argv, p, nProcesses);
+		if (p > 0 || confs[p] -> masterWorker) {
+			devices[p] = createDevices(trDataBase, selInstances, transposedTrDataBase, confs[p]);
+		}
+	}
+
+
+	/********** The master and the workers run concurrently ***********/
+
+	LocalHub hub(nProcesses);
+	omp_set_nested(1);
+	#pragma omp parallel num_threads(nProcesses)
+	{
+		int p = omp_get_thread_num();
+		LocalTransport transport(&hub, p);
+		agIslands((p == 0) ? subpops : NULL, devices[p], trDataBase, NULL, selInstances, &transport, confs[p]);
 	}
 
-	// Variables used by both master and workers are released
-	Individual_MPI_type.Free();
+	// The results file is written with the configuration of the simulated master, so it must be finished before releasing it
+	waitResults();
+	for (int p = 0; p < nProcesses; ++p) {
+		delete[] devices[p];
+		delete confs[p];
+	}
 }
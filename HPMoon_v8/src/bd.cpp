@@ -8,115 +8,956 @@
 /********************************* Includes *******************************/
 
 #include "bd.h"
+#include <algorithm> // std::min, std::max, std::count
+#include <charconv> // std::from_chars
+#include <climits> // INT_MAX
 #include <cmath> // exp, sqrt...
-#include <sstream> // stringstream
+#include <fcntl.h> // open
+#include <functional> // std::function
+#include <omp.h> // omp_get_max_threads
+#include <string.h> // memcpy, memset
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+#include <vector> // std::vector...
 
 /********************************* Methods ********************************/
 
+/**
+ * @brief Computes the average and the standard deviation of each feature in a single row-wise pass over blocks of instances, which are merged in a fixed order (Welford's algorithm and Chan's formula)
+ * @param dataBase The database
+ * @param nInstances The number of instances of the database
+ * @param nFeatures The number of features of each instance
+ * @param featureAverage Output average of each feature
+ * @param invDeviation Output inverse of the standard deviation of each feature
+ */
+void getFeatureStatistics(const float *const dataBase, const int nInstances, const int nFeatures, std::vector<float> &featureAverage, std::vector<float> &invDeviation) {
+
+	// The blocks do not depend on the number of threads, so the result is always the same
+	const int blockInstances = std::max(4096, (nInstances + 255) / 256);
+	const int nBlocks = (nInstances + blockInstances - 1) / blockInstances;
+	std::vector<double> blockAverage((size_t) nBlocks * nFeatures, 0.0);
+	std::vector<double> blockM2((size_t) nBlocks * nFeatures, 0.0);
+
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (int b = 0; b < nBlocks; ++b) {
+		double *const average = &blockAverage[(size_t) b * nFeatures];
+		double *const m2 = &blockM2[(size_t) b * nFeatures];
+		const int first = b * blockInstances;
+		const int last = std::min(first + blockInstances, nInstances);
+		for (int i = first; i < last; ++i) {
+			const float *const instance = dataBase + ((size_t) nFeatures * i);
+			const double invCount = 1.0 / (i - first + 1);
+			#pragma omp simd
+			for (int f = 0; f < nFeatures; ++f) {
+				double delta = instance[f] - average[f];
+				average[f] += delta * invCount;
+				m2[f] += delta * (instance[f] - average[f]);
+			}
+		}
+	}
+
+	// The statistics of the blocks are merged
+	std::vector<double> average(blockAverage.begin(), blockAverage.begin() + nFeatures);
+	std::vector<double> m2(blockM2.begin(), blockM2.begin() + nFeatures);
+	for (int b = 1; b < nBlocks; ++b) {
+		const double count = (double) b * blockInstances;
+		const double countBlock = std::min(blockInstances, nInstances - (b * blockInstances));
+		for (int f = 0; f < nFeatures; ++f) {
+			double delta = blockAverage[((size_t) b * nFeatures) + f] - average[f];
+			average[f] += delta * countBlock / (count + countBlock);
+			m2[f] += blockM2[((size_t) b * nFeatures) + f] + (delta * delta * count * countBlock / (count + countBlock));
+		}
+	}
+
+	// Standard deviation of the features vector
+	featureAverage.resize(nFeatures);
+	invDeviation.resize(nFeatures);
+	for (int f = 0; f < nFeatures; ++f) {
+		featureAverage[f] = (float) average[f];
+		invDeviation[f] = (float) (1.0 / sqrt(m2[f] / (nInstances - 1)));
+	}
+}
+
+
+/**
+ * @brief Normalizes a set of continuous values using SoftMax (based on the logistic function) with the given statistics of the features
+ * @param dataBase Database to be normalized
+ * @param transposedDataBase The place where the normalized database is also stored already transposed, or NULL
+ * @param nInstances The number of instances of the database
+ * @param nFeatures The number of features of each instance
+ * @param featureAverage The average of each feature
+ * @param invDeviation The inverse of the standard deviation of each feature
+ */
+void applyNormalization(float *const dataBase, float *const transposedDataBase, const int nInstances, const int nFeatures, const std::vector<float> &featureAverage, const std::vector<float> &invDeviation) {
+
+	// Each tile of instances is also transposed while it is in cache
+	const int tileInstances = 64;
+	#pragma omp parallel for schedule(static)
+	for (int first = 0; first < nInstances; first += tileInstances) {
+		const int last = std::min(first + tileInstances, nInstances);
+		for (int i = first; i < last; ++i) {
+			float *const instance = dataBase + ((size_t) nFeatures * i);
+			#pragma omp simd
+			for (int f = 0; f < nFeatures; ++f) {
+				float x_scaled = (instance[f] - featureAverage[f]) * invDeviation[f];
+				instance[f] = 1.0f / (1.0f + expf(-x_scaled));
+			}
+		}
+
+		if (transposedDataBase != NULL) {
+			for (int f = 0; f < nFeatures; ++f) {
+				float *const column = transposedDataBase + ((size_t) nInstances * f);
+				for (int i = first; i < last; ++i) {
+					column[i] = dataBase[((size_t) nFeatures * i) + f];
+				}
+			}
+		}
+	}
+}
+
+
 /**
  * @brief The database is normalized between 0.0 and 1.0
+ *
+ * The statistics of all features are computed in a single row-wise pass. Then, the logistic function is applied in a second parallel pass
  * @param dataBase Database to be normalized
- * @param conf The structure with all configuration parameters
+ * @param transposedDataBase The place where the normalized database is also stored already transposed, or NULL
+ * @param nInstances The number of instances of the database
+ * @param nFeatures The number of features of each instance
+ */
+void normDataBase(float *const dataBase, float *const transposedDataBase, const int nInstances, const int nFeatures) {
+
+	std::vector<float> featureAverage;
+	std::vector<float> invDeviation;
+	getFeatureStatistics(dataBase, nInstances, nFeatures, featureAverage, invDeviation);
+	applyNormalization(dataBase, transposedDataBase, nInstances, nFeatures, featureAverage, invDeviation);
+}
+
+
+/**
+ * @brief Checks if a character separates the values of a text database
+ * @param c The character
+ * @return True if the character is a blank or false otherwise
  */
-void normDataBase(float *const dataBase, const Config *const conf) {
+inline bool isBlank(const char c) {
 
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+/**
+ * @brief Parses the values of a line of a text database
+ * @param begin The first character of the line
+ * @param end The end of the line
+ * @param values The place where the values are stored, or NULL if they are only counted
+ * @param stride The distance between consecutive values in "values"
+ * @param maxValues The maximum number of values to be stored
+ * @return The number of values in the line, or -1 if some value is not a number
+ */
+int parseLine(const char *begin, const char *const end, float *const values, const size_t stride, const int maxValues) {
+
+	int nValues = 0;
+	while (true) {
+		while (begin < end && isBlank(*begin)) {
+			++begin;
+		}
+		if (begin == end) {
+			return nValues;
+		}
+
+		// "std::from_chars" does not accept an explicit positive sign
+		if (*begin == '+') {
+			++begin;
+		}
+		float value;
+		std::from_chars_result result = std::from_chars(begin, end, value);
+		if (result.ec != std::errc() || (result.ptr < end && !isBlank(*result.ptr))) {
+			return -1;
+		}
+		if (values != NULL && nValues < maxValues) {
+			values[nValues * stride] = value;
+		}
+		begin = result.ptr;
+		++nValues;
+	}
+}
 
-	/********** Database normalization ***********/
 
-	for(int j = 0; j < conf -> nFeatures; ++j) {
+/**
+ * @brief Parses the "feature:value" pairs of a line of a sparse text database. The pairs whose value is zero are skipped
+ * @param begin The first character of the line
+ * @param end The end of the line
+ * @param features The place where the features of the non-zero values are stored, or NULL if they are only counted
+ * @param values The place where the non-zero values are stored, or NULL if they are only counted
+ * @param maxFeature Output greatest feature of the line, or -1 if the line is empty
+ * @return The number of non-zero values in the line, or -1 if some pair is wrong or the features are not in increasing order
+ */
+int parseSparseLine(const char *begin, const char *const end, int *const features, float *const values, int *const maxFeature) {
 
-		// Average of the features vector
-		float average = 0;
-		for(int i = 0; i < conf -> trNInstances; ++i) {
-			int pos = (conf -> nFeatures * i) + j;
-			average += dataBase[pos];
+	int nValues = 0;
+	*maxFeature = -1;
+	while (true) {
+		while (begin < end && isBlank(*begin)) {
+			++begin;
+		}
+		if (begin == end) {
+			return nValues;
 		}
 
-		average /= conf -> trNInstances;
+		int feature;
+		std::from_chars_result result = std::from_chars(begin, end, feature);
+		if (result.ec != std::errc() || result.ptr == end || *result.ptr != ':' || feature <= *maxFeature) {
+			return -1;
+		}
+		begin = result.ptr + 1;
 
-		// Variance of the features vector
-		float variance = 0;
-		for(int i = 0; i < conf -> trNInstances; ++i) {
-			int pos = (conf -> nFeatures * i) + j;
-			variance += (dataBase[pos] - average) * (dataBase[pos] - average);
+		// "std::from_chars" does not accept an explicit positive sign
+		if (begin < end && *begin == '+') {
+			++begin;
+		}
+		float value;
+		result = std::from_chars(begin, end, value);
+		if (result.ec != std::errc() || (result.ptr < end && !isBlank(*result.ptr))) {
+			return -1;
 		}
-		variance /= (conf -> trNInstances - 1);
+		if (value != 0.0f) {
+			if (features != NULL) {
+				features[nValues] = feature;
+				values[nValues] = value;
+			}
+			++nValues;
+		}
+		*maxFeature = feature;
+		begin = result.ptr;
+	}
+}
+
+
+/**
+ * @brief Maps a text database in memory
+ * @param fileName The name of the database file
+ * @param fileSize Output size of the file in bytes
+ * @return The content of the file. It must be released with "munmap"
+ */
+const char* mapTextFile(const char *const fileName, size_t *const fileSize) {
+
+	int fd = open(fileName, O_RDONLY);
+	check(fd < 0, "%s\n", BD_ERROR_FILE_OPEN);
+	struct stat fileStat;
+	check(fstat(fd, &fileStat) != 0, "%s\n", BD_ERROR_FILE_OPEN);
+	*fileSize = fileStat.st_size;
+	if (*fileSize == 0) {
+		close(fd);
+		check(true, "%s\n", BD_ERROR_FILE_EMPTY);
+	}
+	const char *const text = (const char *) mmap(NULL, *fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	check(text == MAP_FAILED, "%s\n", BD_ERROR_FILE_OPEN);
+	madvise((void *) text, *fileSize, MADV_SEQUENTIAL);
+
+	return text;
+}
 
-		// Standard deviation of the features vector
-		float std_deviation = sqrt(variance);
 
-		// Normalize a set of continuous values using SoftMax (based on the logistic function)
-		for(int i = 0; i < conf -> trNInstances; ++i) {
-			int pos = (conf -> nFeatures * i) + j;
-			float x_scaled = (dataBase[pos] - average) / std_deviation;
-			dataBase[pos] = 1.0f / (1.0f + exp(-x_scaled));
+/**
+ * @brief Splits a text database mapped in memory into chunks of complete lines, which can be parsed in parallel, and counts the lines of each chunk
+ * @param text The content of the file
+ * @param fileSize The size of the file in bytes
+ * @param chunkBegin Output first character of each chunk. The last element is the end of the file
+ * @param chunkFirstRow Output first line of each chunk. The last element is the number of lines of the file
+ */
+void splitTextFile(const char *const text, const size_t fileSize, std::vector<const char*> &chunkBegin, std::vector<int> &chunkFirstRow) {
+
+	const char *const textEnd = text + fileSize;
+	const int nChunks = omp_get_max_threads() * 4;
+	chunkBegin.assign(nChunks + 1, textEnd);
+	chunkBegin[0] = text;
+	for (int c = 1; c < nChunks; ++c) {
+		const char *begin = std::max(chunkBegin[c - 1], text + ((fileSize * c) / nChunks));
+		const char *newLine = (begin == text) ? text : (const char *) memchr(begin - 1, '\n', textEnd - begin + 1);
+		chunkBegin[c] = (newLine == NULL) ? textEnd : std::max(newLine + 1, begin);
+	}
+
+	// As "getline" does, the last line does not need to end with a new line character
+	chunkFirstRow.assign(nChunks + 1, 0);
+	#pragma omp parallel for
+	for (int c = 0; c < nChunks; ++c) {
+		int nLines = (int) std::count(chunkBegin[c], chunkBegin[c + 1], '\n');
+		if (chunkBegin[c + 1] == textEnd && chunkBegin[c] < textEnd && textEnd[-1] != '\n') {
+			++nLines;
 		}
+		chunkFirstRow[c + 1] = nLines;
+	}
+	for (int c = 0; c < nChunks; ++c) {
+		chunkFirstRow[c + 1] += chunkFirstRow[c];
 	}
 }
 
 
 /**
- * @brief Reads and normalizes a database if it is required
+ * @brief Reads a database stored as text, whose features are separated by blanks, in a single pass. The file is mapped in memory and split into chunks of complete lines, which are parsed in parallel
+ * @param fileName The name of the database file
+ * @param nRows Output number of instances in the file
+ * @param nCols Output number of features
+ * @param getBuffers Function which receives the dimensions once they are known, checks them and returns the places where the instances will be stored (row-major and transposed). The second one can be NULL
+ * @param nStored The number of first instances which are stored. If it is negative, all the instances are stored
+ */
+void parseTextDataBase(const char *const fileName, int *const nRows, int *const nCols, const std::function<std::pair<float*, float*> (const int, const int)> &getBuffers, int nStored = -1) {
+
+	size_t fileSize;
+	const char *const text = mapTextFile(fileName, &fileSize);
+	const char *const textEnd = text + fileSize;
+	std::vector<const char*> chunkBegin;
+	std::vector<int> chunkFirstRow;
+	splitTextFile(text, fileSize, chunkBegin, chunkFirstRow);
+	const int nChunks = chunkBegin.size() - 1;
+
+
+	/********** Getting the database dimensions from the first line ***********/
+
+	*nRows = chunkFirstRow[nChunks];
+	const char *firstLineEnd = (const char *) memchr(text, '\n', fileSize);
+	*nCols = parseLine(text, (firstLineEnd == NULL) ? textEnd : firstLineEnd, NULL, 0, 0);
+	check(*nCols < 0, "%s %d\n", BD_ERROR_ROW_UNEQUAL, 1);
+	check(*nRows < 4 || *nCols < 4, "%s\n", BD_ERROR_DIMENSIONS_MIN);
+	nStored = (nStored < 0) ? *nRows : std::min(nStored, *nRows);
+	std::pair<float*, float*> buffers = getBuffers(*nRows, *nCols);
+
+
+	/********** Parse the chunks and store each value in its final place ***********/
+
+	// The columns of all lines are checked. The first wrong line is reported
+	int firstWrongRow = INT_MAX;
+	#pragma omp parallel for schedule(dynamic, 1) reduction(min:firstWrongRow)
+	for (int c = 0; c < nChunks; ++c) {
+		const char *begin = chunkBegin[c];
+		for (int row = chunkFirstRow[c]; row < chunkFirstRow[c + 1]; ++row) {
+			const char *end = (const char *) memchr(begin, '\n', chunkBegin[c + 1] - begin);
+			end = (end == NULL) ? chunkBegin[c + 1] : end;
+			int nValues;
+			if (row < nStored) {
+				float *const values = buffers.first + ((size_t) *nCols * row);
+				nValues = parseLine(begin, end, values, 1, *nCols);
+
+				// The values of the line are still in cache when they are transposed
+				if (buffers.second != NULL && nValues == *nCols) {
+					for (int f = 0; f < *nCols; ++f) {
+						buffers.second[((size_t) nStored * f) + row] = values[f];
+					}
+				}
+			}
+			else {
+				nValues = parseLine(begin, end, NULL, 0, 0);
+			}
+			if (nValues != *nCols) {
+				firstWrongRow = std::min(firstWrongRow, row + 1);
+				break;
+			}
+			begin = end + 1;
+		}
+	}
+
+	munmap((void *) text, fileSize);
+	check(firstWrongRow != INT_MAX, "%s %d\n", BD_ERROR_ROW_UNEQUAL, firstWrongRow);
+}
+
+
+/**
+ * @brief Reads a sparse text database, whose instances are lists of "feature:value" pairs separated by blanks. The file is mapped in memory and split into chunks of complete lines, which are parsed in parallel twice: the non-zero values of each instance are counted in the first pass and stored row by row in the second one. Then, they are transposed into the compressed sparse column format
+ * @param fileName The name of the database file
+ * @param nRows Output number of instances in the file
+ * @param nCols Output number of features, which is the greatest feature of the file plus one
+ * @param dataBase The place where the first instances will be stored, or NULL if the file is only checked
+ * @param nStored The number of first instances which are stored
+ */
+void parseSparseTextDataBase(const char *const fileName, int *const nRows, int *const nCols, SparseDataBase *const dataBase, const int nStored) {
+
+	size_t fileSize;
+	const char *const text = mapTextFile(fileName, &fileSize);
+	std::vector<const char*> chunkBegin;
+	std::vector<int> chunkFirstRow;
+	splitTextFile(text, fileSize, chunkBegin, chunkFirstRow);
+	const int nChunks = chunkBegin.size() - 1;
+	*nRows = chunkFirstRow[nChunks];
+	const int nStoredRows = std::min(nStored, *nRows);
+
+
+	/********** Check all the lines and count the non-zero values of the stored instances ***********/
+
+	std::vector<size_t> rowOffsets((dataBase != NULL) ? nStoredRows + 1 : 0, 0);
+
+	// The first wrong line is reported
+	int firstWrongRow = INT_MAX;
+	int maxFeature = -1;
+	#pragma omp parallel for schedule(dynamic, 1) reduction(min:firstWrongRow) reduction(max:maxFeature)
+	for (int c = 0; c < nChunks; ++c) {
+		const char *begin = chunkBegin[c];
+		for (int row = chunkFirstRow[c]; row < chunkFirstRow[c + 1]; ++row) {
+			const char *end = (const char *) memchr(begin, '\n', chunkBegin[c + 1] - begin);
+			end = (end == NULL) ? chunkBegin[c + 1] : end;
+			int lineMaxFeature;
+			int nValues = parseSparseLine(begin, end, NULL, NULL, &lineMaxFeature);
+			if (nValues < 0) {
+				firstWrongRow = std::min(firstWrongRow, row + 1);
+				break;
+			}
+			maxFeature = std::max(maxFeature, lineMaxFeature);
+			if (dataBase != NULL && row < nStoredRows) {
+				rowOffsets[row + 1] = nValues;
+			}
+			begin = end + 1;
+		}
+	}
+	if (firstWrongRow != INT_MAX) {
+		munmap((void *) text, fileSize);
+		check(true, "%s %d\n", BD_ERROR_SPARSE_ROW, firstWrongRow);
+	}
+	*nCols = maxFeature + 1;
+	check(*nRows < 4 || *nCols < 4, "%s\n", BD_ERROR_DIMENSIONS_MIN);
+
+
+	if (dataBase == NULL) {
+		munmap((void *) text, fileSize);
+		return;
+	}
+
+
+	/********** Store the non-zero values of the first instances row by row ***********/
+
+	for (int row = 0; row < nStoredRows; ++row) {
+		rowOffsets[row + 1] += rowOffsets[row];
+	}
+	const size_t nValues = rowOffsets[nStoredRows];
+	std::vector<int> rowFeatures(nValues);
+	std::vector<float> rowValues(nValues);
+
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (int c = 0; c < nChunks; ++c) {
+		const char *begin = chunkBegin[c];
+		for (int row = chunkFirstRow[c]; row < std::min(chunkFirstRow[c + 1], nStoredRows); ++row) {
+			const char *end = (const char *) memchr(begin, '\n', chunkBegin[c + 1] - begin);
+			end = (end == NULL) ? chunkBegin[c + 1] : end;
+			int lineMaxFeature;
+			parseSparseLine(begin, end, rowFeatures.data() + rowOffsets[row], rowValues.data() + rowOffsets[row], &lineMaxFeature);
+			begin = end + 1;
+		}
+	}
+	munmap((void *) text, fileSize);
+
+
+	/********** Transpose the values into the compressed sparse column format. The instances are visited in order, so they are sorted inside each feature ***********/
+
+	dataBase -> featureOffsets.assign(*nCols + 1, 0);
+	for (size_t v = 0; v < nValues; ++v) {
+		++(dataBase -> featureOffsets[rowFeatures[v] + 1]);
+	}
+	for (int f = 0; f < *nCols; ++f) {
+		dataBase -> featureOffsets[f + 1] += dataBase -> featureOffsets[f];
+	}
+	dataBase -> instances.resize(nValues);
+	dataBase -> values.resize(nValues);
+	std::vector<size_t> next(dataBase -> featureOffsets.begin(), dataBase -> featureOffsets.end() - 1);
+	for (int row = 0; row < nStoredRows; ++row) {
+		for (size_t v = rowOffsets[row]; v < rowOffsets[row + 1]; ++v) {
+			const size_t pos = next[rowFeatures[v]]++;
+			dataBase -> instances[pos] = row;
+			dataBase -> values[pos] = rowValues[v];
+		}
+	}
+}
+
+
+/**
+ * @brief Reads all the instances of a database stored as text, whose features are separated by blanks. The file is parsed in parallel in a single pass
+ * @param fileName The name of the database file
+ * @param nRows Output number of instances
+ * @param nCols Output number of features
+ * @return The instances
+ */
+float* readTextDataBase(const char *const fileName, int *const nRows, int *const nCols) {
+
+	float *dataBase = NULL;
+	parseTextDataBase(fileName, nRows, nCols, [&dataBase](const int nRows, const int nCols) {
+		dataBase = new float[(size_t) nRows * nCols];
+		return std::pair<float*, float*>(dataBase, NULL);
+	});
+
+	return dataBase;
+}
+
+
+/**
+ * @brief Writes a database in the binary columnar format
+ * @param fileName The name of the binary database file
+ * @param dataBase The instances
+ * @param nInstances The number of instances of the database
+ * @param nFeatures The number of features of each instance
+ * @param normalized If the instances are already normalized
+ */
+void writeBinaryDataBase(const char *const fileName, const float *const dataBase, const int nInstances, const int nFeatures, const bool normalized) {
+
+
+	/********** Layout of the blocks ***********/
+
+	const uint64_t blockSize = (uint64_t) nInstances * nFeatures * sizeof(float);
+	BinaryDataBaseHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = BD_BINARY_MAGIC;
+	header.version = BD_BINARY_VERSION;
+	header.nInstances = nInstances;
+	header.nFeatures = nFeatures;
+	header.normalized = normalized;
+	header.rowsOffset = BD_BINARY_ALIGNMENT;
+	header.transposedOffset = header.rowsOffset + (((blockSize + BD_BINARY_ALIGNMENT - 1) / BD_BINARY_ALIGNMENT) * BD_BINARY_ALIGNMENT);
+
+
+	/********** Both blocks are written after the header ***********/
+
+	std::fstream fData(fileName, std::fstream::out | std::fstream::binary | std::fstream::trunc);
+	check(!fData.is_open(), "%s\n", BD_ERROR_FILE_OPEN);
+	std::vector<char> padding(BD_BINARY_ALIGNMENT, 0);
+	fData.write((const char *) &header, sizeof(header));
+	fData.write(padding.data(), header.rowsOffset - sizeof(header));
+	fData.write((const char *) dataBase, blockSize);
+	fData.write(padding.data(), header.transposedOffset - header.rowsOffset - blockSize);
+
+	// The transposed block is written feature by feature
+	std::vector<float> column(nInstances);
+	for (int f = 0; f < nFeatures; ++f) {
+		for (int i = 0; i < nInstances; ++i) {
+			column[i] = dataBase[((size_t) nFeatures * i) + f];
+		}
+		fData.write((const char *) column.data(), nInstances * sizeof(float));
+	}
+	fData.close();
+	check(fData.fail(), "%s\n", BD_ERROR_FILE_WRITE);
+}
+
+
+/**
+ * @brief Checks if the database file is stored in the binary columnar format
  * @param conf The structure with all configuration parameters
- * @return The database which will contain the instances
+ * @return True if the file starts with the identifier of the binary format or false otherwise
  */
-float* getDataBase(const Config *const conf) {
+bool isBinaryDataBase(const Config *const conf) {
 
+	std::fstream fData(conf -> trDataBaseFileName.c_str(), std::fstream::in | std::fstream::binary);
+	check(!fData.is_open(), "%s\n", BD_ERROR_FILE_OPEN);
+	uint32_t magic = 0;
+	fData.read((char *) &magic, sizeof(magic));
+	return fData.gcount() == sizeof(magic) && magic == BD_BINARY_MAGIC;
+}
+
+
+/**
+ * @brief Checks if the database file is stored as sparse text, whose instances are lists of "feature:value" pairs
+ * @param conf The structure with all configuration parameters
+ * @return True if the first non-empty line contains a pair or false otherwise
+ */
+bool isSparseDataBase(const Config *const conf) {
 
-	/********** Open the database ***********/
+	if (isBinaryDataBase(conf)) {
+		return false;
+	}
 
 	std::fstream fData(conf -> trDataBaseFileName.c_str(), std::fstream::in);
 	check(!fData.is_open(), "%s\n", BD_ERROR_FILE_OPEN);
+	std::string line;
+	while (std::getline(fData, line)) {
+		if (line.find_first_not_of(" \t\r\v\f") != std::string::npos) {
+			return line.find(':') != std::string::npos;
+		}
+	}
+
+	return false;
+}
 
 
-	/********** Getting the database dimensions ***********/
+/**
+ * @brief Gets the number of features of the database from the header of a binary database, from the first row of a text database or from the greatest feature of a sparse database
+ * @param conf The structure with all configuration parameters
+ * @return The number of features
+ */
+int getDataBaseFeatures(const Config *const conf) {
 
-	int nRows = 1, nCols = 0;
-	float dato;
+	std::fstream fData(conf -> trDataBaseFileName.c_str(), std::fstream::in | std::fstream::binary);
+	check(!fData.is_open(), "%s\n", BD_ERROR_FILE_OPEN);
+	BinaryDataBaseHeader header;
+	fData.read((char *) &header, sizeof(header));
+	if (fData.gcount() == sizeof(header) && header.magic == BD_BINARY_MAGIC) {
+		return (int) std::min(header.nFeatures, (uint32_t) INT_MAX);
+	}
+
+	// The features of a sparse database can only be known after checking all its instances
+	if (isSparseDataBase(conf)) {
+		int nRows, nCols;
+		parseSparseTextDataBase(conf -> trDataBaseFileName.c_str(), &nRows, &nCols, NULL, 0);
+		return nCols;
+	}
+
+	fData.clear();
+	fData.seekg(0);
 	std::string line;
-	if(!getline(fData, line)) {
-		fData.close();
-		check(true, "%s\n", BD_ERROR_FILE_EMPTY);
+	std::getline(fData, line);
+	check(line.empty() && fData.eof(), "%s\n", BD_ERROR_FILE_EMPTY);
+	int nCols = parseLine(line.data(), line.data() + line.size(), NULL, 0, 0);
+	check(nCols < 0, "%s %d\n", BD_ERROR_ROW_UNEQUAL, 1);
+	return nCols;
+}
+
+
+/**
+ * @brief Checks that the header of a binary database is valid and that it matches the parameters specified in configuration
+ * @param header The header of the binary database
+ * @param fileSize The size of the binary database file in bytes
+ * @param conf The structure with all configuration parameters
+ */
+void checkBinaryHeader(const BinaryDataBaseHeader *const header, const size_t fileSize, const Config *const conf) {
+
+	const uint64_t blockSize = (uint64_t) header -> nInstances * header -> nFeatures * sizeof(float);
+	check(header -> version != BD_BINARY_VERSION || header -> rowsOffset + blockSize > header -> transposedOffset || header -> transposedOffset + blockSize > fileSize, "%s\n", BD_ERROR_BINARY_FORMAT);
+	check(header -> nInstances < 4 || header -> nFeatures < 4, "%s\n", BD_ERROR_DIMENSIONS_MIN);
+	check(conf -> trNInstances < 4 || (uint32_t) conf -> trNInstances > header -> nInstances, "%s %u\n", BD_ERROR_INSTANCES_RANGE, header -> nInstances);
+	check((uint32_t) conf -> nFeatures != header -> nFeatures, "%s\n", BD_ERROR_COLUMNS_UNEQUAL);
+}
+
+
+/**
+ * @brief Reads a database stored in the binary columnar format. The file is mapped in memory, so the instances are copied without parsing them or transposing them
+ * @param dataBase The place where the instances will be stored
+ * @param transposedDataBase The place where the transposed instances will be stored, or NULL if they are not needed
+ * @param conf The structure with all configuration parameters
+ */
+void readBinaryDataBase(float *const dataBase, float *const transposedDataBase, const Config *const conf) {
+
+
+	/********** Map the whole file ***********/
+
+	int fd = open(conf -> trDataBaseFileName.c_str(), O_RDONLY);
+	check(fd < 0, "%s\n", BD_ERROR_FILE_OPEN);
+	struct stat fileStat;
+	check(fstat(fd, &fileStat) != 0 || (size_t) fileStat.st_size < sizeof(BinaryDataBaseHeader), "%s\n", BD_ERROR_BINARY_FORMAT);
+	const size_t fileSize = fileStat.st_size;
+	void *mapping = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	check(mapping == MAP_FAILED, "%s\n", BD_ERROR_FILE_OPEN);
+
+
+	/********** Check the header and the parameters specified in configuration ***********/
+
+	BinaryDataBaseHeader header;
+	memcpy(&header, mapping, sizeof(header));
+	checkBinaryHeader(&header, fileSize, conf);
+
+
+	/********** The instances are taken from the blocks as they are ***********/
+
+	const float *rows = (const float *) ((const char *) mapping + header.rowsOffset);
+	const float *columns = (const float *) ((const char *) mapping + header.transposedOffset);
+	const size_t dbSize = (size_t) conf -> trNInstances * conf -> nFeatures;
+	memcpy(dataBase, rows, dbSize * sizeof(float));
+
+	// The first instances of each feature are contiguous in the transposed block
+	if (transposedDataBase != NULL) {
+		for (int f = 0; f < conf -> nFeatures; ++f) {
+			memcpy(transposedDataBase + ((size_t) conf -> trNInstances * f), columns + ((size_t) header.nInstances * f), conf -> trNInstances * sizeof(float));
+		}
+	}
+	munmap(mapping, fileSize);
+
+	// Normalize the database if it was not normalized when it was converted
+	if (conf -> trNormalize && !header.normalized) {
+		normDataBase(dataBase, transposedDataBase, conf -> trNInstances, conf -> nFeatures);
+	}
+}
+
+
+/**
+ * @brief Maps the instances of a binary database in memory for the out-of-core mode. The operating system reads them from the file when they are accessed and discards them when the memory is needed, so the database can be larger than the memory
+ * @param conf The structure with all configuration parameters
+ * @return The instances in row-major order. They must be released with "unmapDataBase"
+ */
+const float* mapDataBase(const Config *const conf) {
+
+
+	/********** Only the normalized binary databases can be used as they are ***********/
+
+	check(!isBinaryDataBase(conf), "%s\n", BD_ERROR_OUT_OF_CORE_FORMAT);
+	int fd = open(conf -> trDataBaseFileName.c_str(), O_RDONLY);
+	check(fd < 0, "%s\n", BD_ERROR_FILE_OPEN);
+	struct stat fileStat;
+	BinaryDataBaseHeader header;
+	check(fstat(fd, &fileStat) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header), "%s\n", BD_ERROR_BINARY_FORMAT);
+	checkBinaryHeader(&header, fileStat.st_size, conf);
+	check(conf -> trNormalize && !header.normalized, "%s\n", BD_ERROR_OUT_OF_CORE_FORMAT);
+
+
+	/********** Map the first instances of the row-major block ***********/
+
+	// The offset of a mapping must be a multiple of the page size
+	const size_t pageSize = sysconf(_SC_PAGESIZE);
+	const size_t mappingOffset = (header.rowsOffset / pageSize) * pageSize;
+	const size_t mappingSize = (header.rowsOffset - mappingOffset) + ((size_t) conf -> trNInstances * conf -> nFeatures * sizeof(float));
+	void *mapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fd, mappingOffset);
+	close(fd);
+	check(mapping == MAP_FAILED, "%s\n", BD_ERROR_FILE_OPEN);
+
+	return (const float *) ((const char *) mapping + (header.rowsOffset - mappingOffset));
+}
+
+
+/**
+ * @brief Releases the instances mapped in memory for the out-of-core mode
+ * @param trDataBase The instances returned by "mapDataBase"
+ * @param conf The structure with all configuration parameters
+ */
+void unmapDataBase(const float *const trDataBase, const Config *const conf) {
+
+	const size_t pageSize = sysconf(_SC_PAGESIZE);
+	const char *mapping = (const char *) (((uintptr_t) trDataBase / pageSize) * pageSize);
+	munmap((void *) mapping, ((const char *) trDataBase - mapping) + ((size_t) conf -> trNInstances * conf -> nFeatures * sizeof(float)));
+}
+
+
+/**
+ * @brief Quantizes the training database to 8 bits. The range of the features is computed and the instances are quantized in parallel
+ * @param trDataBase The training database, already normalized if it is required
+ * @param conf The structure with all configuration parameters
+ * @return The quantized database
+ */
+QuantizedDataBase* quantizeDataBase(const float *const trDataBase, const Config *const conf) {
+
+	const int nFeatures = conf -> nFeatures;
+	QuantizedDataBase *quantized = new QuantizedDataBase;
+	quantized -> stride = ((nFeatures + BD_QUANTIZED_ALIGNMENT - 1) / BD_QUANTIZED_ALIGNMENT) * BD_QUANTIZED_ALIGNMENT;
+	quantized -> values.assign((size_t) conf -> trNInstances * quantized -> stride, 0);
+
+
+	/********** Range of each feature ***********/
+
+	std::vector<float> minimum(trDataBase, trDataBase + nFeatures);
+	std::vector<float> maximum(trDataBase, trDataBase + nFeatures);
+	float *const minPtr = minimum.data();
+	float *const maxPtr = maximum.data();
+	#pragma omp parallel for reduction(min:minPtr[:nFeatures]) reduction(max:maxPtr[:nFeatures])
+	for (int i = 1; i < conf -> trNInstances; ++i) {
+		const float *const instance = trDataBase + ((size_t) nFeatures * i);
+		for (int f = 0; f < nFeatures; ++f) {
+			minPtr[f] = std::min(minPtr[f], instance[f]);
+			maxPtr[f] = std::max(maxPtr[f], instance[f]);
+		}
+	}
+
+	// The widest feature determines the scale shared by all features
+	float range = 0.0f;
+	for (int f = 0; f < nFeatures; ++f) {
+		range = std::max(range, maximum[f] - minimum[f]);
 	}
+	quantized -> offset = minimum;
+	quantized -> scale = (range > 0.0f) ? range / BD_QUANTIZED_LEVELS : 1.0f;
 
-	std::stringstream ss(line);
-	while(ss >> dato) {
-		++nCols;
+
+	/********** Quantize the instances ***********/
+
+	const float invScale = 1.0f / quantized -> scale;
+	#pragma omp parallel for
+	for (int i = 0; i < conf -> trNInstances; ++i) {
+		const float *const instance = trDataBase + ((size_t) nFeatures * i);
+		unsigned char *const values = &(quantized -> values[(size_t) quantized -> stride * i]);
+		for (int f = 0; f < nFeatures; ++f) {
+			values[f] = (unsigned char) std::min(BD_QUANTIZED_LEVELS, (int) lrintf((instance[f] - minPtr[f]) * invScale));
+		}
 	}
 
-	while(getline(fData, line)) {
-		++nRows;
-		std::stringstream aux(line);
-		int tmp = 0;
-		while(aux >> dato) {
-			++tmp;
+	return quantized;
+}
+
+
+/**
+ * @brief The sparse database is normalized between -1.0 and 1.0, or between 0.0 and 1.0 if its values are not negative. Each feature is divided by its greatest absolute value, so the zeros are kept and the database remains sparse
+ * @param dataBase Database to be normalized
+ * @param nFeatures The number of features of each instance
+ */
+void normSparseDataBase(SparseDataBase *const dataBase, const int nFeatures) {
+
+	// The values of each feature are contiguous, so the features are normalized in parallel
+	#pragma omp parallel for schedule(dynamic, 64)
+	for (int f = 0; f < nFeatures; ++f) {
+		float *const first = dataBase -> values.data() + dataBase -> featureOffsets[f];
+		float *const last = dataBase -> values.data() + dataBase -> featureOffsets[f + 1];
+		float maximum = 0.0f;
+		for (float *value = first; value < last; ++value) {
+			maximum = std::max(maximum, fabsf(*value));
+		}
+		for (float *value = first; value < last; ++value) {
+			*value /= maximum;
 		}
-		check(tmp != nCols, "%s %d\n", BD_ERROR_ROW_UNEQUAL, nRows);
 	}
+}
 
 
-	/********** Check the parameters specified in configuration ***********/
+/**
+ * @brief Reads a sparse text database in compressed sparse column format and normalizes it if it is required. The file is parsed in parallel
+ * @param conf The structure with all configuration parameters
+ * @return The database
+ */
+SparseDataBase* readSparseDataBase(const Config *const conf) {
 
-	check(nRows < 4 || nCols < 4, "%s\n", BD_ERROR_DIMENSIONS_MIN);
+	SparseDataBase *dataBase = new SparseDataBase;
+	int nRows, nCols;
+	parseSparseTextDataBase(conf -> trDataBaseFileName.c_str(), &nRows, &nCols, dataBase, conf -> trNInstances);
 	check(conf -> trNInstances < 4 || conf -> trNInstances > nRows, "%s %d\n", BD_ERROR_INSTANCES_RANGE, nRows);
 	check(conf -> nFeatures != nCols, "%s\n", BD_ERROR_COLUMNS_UNEQUAL);
 
+	// Normalize the database if it is required
+	if (conf -> trNormalize) {
+		normSparseDataBase(dataBase, conf -> nFeatures);
+	}
 
-	/********** Reading and database storage ***********/
+	return dataBase;
+}
 
-	fData.clear();
-	fData.seekg(0);
-	int dbSize = conf -> trNInstances * nCols;
-	float *dataBase = new float[dbSize];
-	for (int i = 0; i < dbSize; ++i) {
-		fData >> dataBase[i];
+
+/**
+ * @brief Appends to the database the complete lines added to its text file since the last call, until the database is full. The lines are parsed in parallel and normalized if it is required
+ * @param stream The growing database
+ * @param conf The structure with all configuration parameters. The number of instances is updated
+ * @return The number of appended instances
+ */
+int appendDataBaseStream(DataBaseStream *const stream, Config *const conf) {
+
+	if (conf -> trNInstances >= stream -> capacity) {
+		return 0;
 	}
-	fData.close();
 
-	// Normalize the database if it is required and return it
+
+	/********** Read the bytes appended to the file since the last call ***********/
+
+	int fd = open(conf -> trDataBaseFileName.c_str(), O_RDONLY);
+	check(fd < 0, "%s\n", BD_ERROR_FILE_OPEN);
+	struct stat fileStat;
+	check(fstat(fd, &fileStat) != 0, "%s\n", BD_ERROR_FILE_OPEN);
+	std::vector<char> text(((size_t) fileStat.st_size > stream -> fileOffset) ? fileStat.st_size - stream -> fileOffset : 0);
+	size_t nRead = 0;
+	while (nRead < text.size()) {
+		ssize_t nBytes = pread(fd, text.data() + nRead, text.size() - nRead, stream -> fileOffset + nRead);
+		if (nBytes <= 0) {
+			break;
+		}
+		nRead += nBytes;
+	}
+	close(fd);
+
+
+	/********** Only the complete lines are taken, because the last one could still be being written ***********/
+
+	const char *const textEnd = text.data() + nRead;
+	const int maxLines = stream -> capacity - conf -> trNInstances;
+	std::vector<const char*> lineBegin(1, text.data());
+	while ((int) lineBegin.size() <= maxLines) {
+		const char *newLine = (const char *) memchr(lineBegin.back(), '\n', textEnd - lineBegin.back());
+		if (newLine == NULL) {
+			break;
+		}
+		lineBegin.push_back(newLine + 1);
+	}
+	const int nLines = lineBegin.size() - 1;
+
+
+	/********** Parse the lines and store each value in its final place ***********/
+
+	const int nFeatures = conf -> nFeatures;
+	const int firstRow = conf -> trNInstances;
+	float *const instances = stream -> instances.data() + ((size_t) nFeatures * firstRow);
+	int firstWrongRow = INT_MAX;
+	#pragma omp parallel for schedule(static) reduction(min:firstWrongRow)
+	for (int l = 0; l < nLines; ++l) {
+		if (parseLine(lineBegin[l], lineBegin[l + 1] - 1, instances + ((size_t) nFeatures * l), 1, nFeatures) != nFeatures) {
+			firstWrongRow = std::min(firstWrongRow, firstRow + l + 1);
+		}
+	}
+	check(firstWrongRow != INT_MAX, "%s %d\n", BD_ERROR_ROW_UNEQUAL, firstWrongRow);
+
+	// The new instances are normalized like the instances already read
+	if (!stream -> featureAverage.empty()) {
+		applyNormalization(instances, NULL, nLines, nFeatures, stream -> featureAverage, stream -> invDeviation);
+	}
+
+	conf -> trNInstances += nLines;
+	stream -> fileOffset += lineBegin.back() - text.data();
+	return nLines;
+}
+
+
+/**
+ * @brief Reads the instances already available in a text database for the streaming mode and normalizes them if it is required. The number of instances in the configuration is the capacity of the database, and it is replaced by the number of instances read
+ * @param conf The structure with all configuration parameters
+ * @return The growing database
+ */
+DataBaseStream* openDataBaseStream(Config *const conf) {
+
+	check(isBinaryDataBase(conf), "%s\n", BD_ERROR_STREAM_FORMAT);
+	DataBaseStream *stream = new DataBaseStream;
+	stream -> capacity = conf -> trNInstances;
+	stream -> instances.resize((size_t) stream -> capacity * conf -> nFeatures);
+	stream -> fileOffset = 0;
+	conf -> trNInstances = 0;
+	appendDataBaseStream(stream, conf);
+	check(conf -> trNInstances < 4, "%s\n", BD_ERROR_DIMENSIONS_MIN);
+
+	// The statistics of the initial instances are kept to normalize the appended ones
+	if (conf -> trNormalize) {
+		getFeatureStatistics(stream -> instances.data(), conf -> trNInstances, conf -> nFeatures, stream -> featureAverage, stream -> invDeviation);
+		applyNormalization(stream -> instances.data(), NULL, conf -> trNInstances, conf -> nFeatures, stream -> featureAverage, stream -> invDeviation);
+	}
+
+	return stream;
+}
+
+
+/**
+ * @brief Reads and normalizes a database if it is required. The instances are stored directly in their final places
+ * @param dataBase The place where the instances will be stored
+ * @param transposedDataBase The place where the transposed instances will be stored, or NULL if they are not needed
+ * @param conf The structure with all configuration parameters
+ */
+void getDataBases(float *const dataBase, float *const transposedDataBase, const Config *const conf) {
+
+
+	/********** The binary databases do not need to be parsed ***********/
+
+	if (isBinaryDataBase(conf)) {
+		readBinaryDataBase(dataBase, transposedDataBase, conf);
+		return;
+	}
+
+
+	/********** The parameters specified in configuration are checked before storing the text database ***********/
+
+	int nRows, nCols;
+	parseTextDataBase(conf -> trDataBaseFileName.c_str(), &nRows, &nCols, [dataBase, transposedDataBase, conf](const int nRows, const int nCols) {
+		check(conf -> trNInstances < 4 || conf -> trNInstances > nRows, "%s %d\n", BD_ERROR_INSTANCES_RANGE, nRows);
+		check(conf -> nFeatures != nCols, "%s\n", BD_ERROR_COLUMNS_UNEQUAL);
+		return std::pair<float*, float*>(dataBase, transposedDataBase);
+	}, conf -> trNInstances);
+
+	// Normalize the database if it is required
 	if (conf -> trNormalize) {
-		normDataBase(dataBase, conf);
+		normDataBase(dataBase, transposedDataBase, conf -> trNInstances, conf -> nFeatures);
 	}
+}
+
+
+/**
+ * @brief Reads and normalizes a database if it is required
+ * @param conf The structure with all configuration parameters
+ * @return The database which will contain the instances
+ */
+float* getDataBase(const Config *const conf) {
+
+	float *dataBase = new float[(size_t) conf -> trNInstances * conf -> nFeatures];
+	getDataBases(dataBase, NULL, conf);
 	return dataBase;
 }
 
@@ -124,20 +965,104 @@ float* getDataBase(const Config *const conf) {
 /**
  * @brief The database is transposed
  * @param dataBase Database to be transposed
+ * @param transposedDataBase The place where the database will be stored already transposed
  * @param conf The structure with all configuration parameters
- * @return The database already transposed
  */
-float* transposeDataBase(const float *const dataBase, const Config *const conf) {
+void transposeDataBase(const float *const dataBase, float *const transposedDataBase, const Config *const conf) {
 
 
 	/********** Transpose database ***********/
 
-	float *dataBaseTransposed = new float[conf -> trNInstances * conf -> nFeatures];
-	for(int f = 0, size = 0; f < conf -> nFeatures; ++f) {
-		for (int i = 0; i < conf -> trNInstances; ++i, ++size) {
-			dataBaseTransposed[size] = dataBase[(conf -> nFeatures * i) + f];
+	// Each tile of instances is transposed while it is in cache
+	const int tileInstances = 64;
+	#pragma omp parallel for schedule(static)
+	for (int first = 0; first < conf -> trNInstances; first += tileInstances) {
+		const int last = std::min(first + tileInstances, conf -> trNInstances);
+		for (int f = 0; f < conf -> nFeatures; ++f) {
+			float *const column = transposedDataBase + ((size_t) conf -> trNInstances * f);
+			for (int i = first; i < last; ++i) {
+				column[i] = dataBase[((size_t) conf -> nFeatures * i) + f];
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Broadcasts the already normalized database as binary floats from the rank 0 of the communicator
+ * @param dataBase The database. Only the rank 0 must provide its content
+ * @param comm Communicator with the ranks which receive the database
+ * @param conf The structure with all configuration parameters
+ */
+void broadcastDataBase(float *const dataBase, const MPI_Comm comm, const Config *const conf) {
+
+
+	/********** Broadcast in chunks to keep the count of each call inside the "int" range ***********/
+
+	const size_t dbSize = (size_t) conf -> trNInstances * conf -> nFeatures;
+	const size_t chunkSize = 1 << 26;
+	for (size_t first = 0; first < dbSize; first += chunkSize) {
+		const int count = (int) std::min(chunkSize, dbSize - first);
+		MPI_Bcast(dataBase + first, count, MPI_FLOAT, 0, comm);
+	}
+}
+
+
+/**
+ * @brief Reads the database and its transposed copy once per node into an MPI shared memory window
+ * @param trDataBase Output pointer to the shared database
+ * @param transposedTrDataBase Output pointer to the shared transposed database
+ * @param window Output window holding both databases. It must be released with "MPI_Win_free"
+ * @param nodeComm Communicator with the worker ranks running on the same node
+ * @param leadersComm Communicator with the master (rank 0) and the owner of each node. If it is "MPI_COMM_NULL", the owner reads the database file by itself
+ * @param conf The structure with all configuration parameters
+ */
+void getSharedDataBases(const float **const trDataBase, const float **const transposedTrDataBase, MPI_Win *const window, const MPI_Comm nodeComm, const MPI_Comm leadersComm, const Config *const conf) {
+
+
+	/********** Allocate the shared window ***********/
+
+	// Only the first rank of the node owns memory. Both databases are stored contiguously
+	int nodeRank;
+	MPI_Comm_rank(nodeComm, &nodeRank);
+	const size_t dbSize = (size_t) conf -> trNInstances * conf -> nFeatures;
+	const MPI_Aint windowSize = (nodeRank == 0) ? (MPI_Aint) (2 * dbSize * sizeof(float)) : 0;
+	float *shared;
+	MPI_Win_allocate_shared(windowSize, sizeof(float), MPI_INFO_NULL, nodeComm, &shared, window);
+
+
+	/********** The owner gets the database and transposes it into the window ***********/
+
+	if (nodeRank == 0) {
+
+		// The master has already read and normalized it
+		if (leadersComm != MPI_COMM_NULL) {
+			broadcastDataBase(shared, leadersComm, conf);
+			transposeDataBase(shared, shared + dbSize, conf);
+		}
+
+		// Both databases are directly stored into the window
+		else {
+			getDataBases(shared, shared + dbSize, conf);
 		}
 	}
 
-	return dataBaseTransposed;
+
+	/********** The rest of ranks map the owner's memory ***********/
+
+	else {
+		MPI_Aint size;
+		int dispUnit;
+		MPI_Win_shared_query(*window, 0, &size, &dispUnit, &shared);
+	}
+
+	// Make the owner's stores visible before anybody reads them
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, *window);
+	MPI_Win_sync(*window);
+	MPI_Barrier(nodeComm);
+	MPI_Win_sync(*window);
+	MPI_Win_unlock_all(*window);
+
+	*trDataBase = shared;
+	*transposedTrDataBase = shared + dbSize;
 }
@@ -0,0 +1,210 @@
+/**
+ * @file checkpoint.cpp
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief File with the necessary implementation to write and read the binary checkpoints of the islands-based genetic algorithm
+ */
+
+/********************************* Includes *******************************/
+
+#include "checkpoint.h"
+#include <cstdio> // rename
+#include <stdlib.h> // initstate, setstate
+#include <string.h> // memcpy
+#include <thread> // std::thread
+#include <vector> // std::vector...
+
+/********************************* Defines ********************************/
+
+#define CHECKPOINT_MAGIC 0x4B43504D // "MPCK" in little endian
+
+/**
+ * @brief The fields at the beginning of the checkpoint. After them, the initial centroids, the number of individuals in the front 0 of each subpopulation, the state of the random generator and the packed subpopulations are stored
+ */
+enum CheckpointHeader {MAGIC, FEATURES, SUBPOPULATIONS, SUBPOPULATION_SIZE, CENTROIDS, NEXT_MIGRATION, RANDOM_STATE, HEADER_SIZE};
+
+/******************************** Variables *******************************/
+
+/**
+ * @brief The background thread which writes the last checkpoint
+ */
+static std::thread writer;
+
+
+/**
+ * @brief The error of the last checkpoint written by the background thread, or NULL if it was written. It is reported by the main thread
+ */
+static const char *writerError = NULL;
+
+
+/**
+ * @brief The states of the random generator used by "random()". Reactivating the current state overwrites its first bytes, so a restored state is copied into the other one before activating it
+ */
+static char randomStates[2][CP_RANDOM_STATE_SIZE];
+static char *randomState = randomStates[0];
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Seeds the random generator used by "random()". Its state is kept by this module, so the checkpoints can store and restore it without altering the sequence of random numbers
+ * @param seed The seed
+ */
+void seedRandom(const unsigned int seed) {
+
+	initstate(seed, randomState, CP_RANDOM_STATE_SIZE);
+}
+
+
+/**
+ * @brief Writes the checkpoint data into a temporary file which replaces the previous checkpoint when it is complete. It runs in a background thread, so the errors are only stored and "waitCheckpoint" reports them
+ * @param data The checkpoint data
+ * @param fileName The name of the checkpoint file
+ */
+void writeCheckpointFile(const std::vector<unsigned char> data, const std::string fileName) {
+
+	std::string tmpFileName = fileName + ".tmp";
+	std::fstream fCheckpoint(tmpFileName.c_str(), std::fstream::out | std::fstream::binary | std::fstream::trunc);
+	if (!fCheckpoint.is_open()) {
+		writerError = CP_ERROR_FILE_OPEN;
+		return;
+	}
+	fCheckpoint.write((const char *) data.data(), data.size());
+	fCheckpoint.close();
+	if (fCheckpoint.fail() || rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+		writerError = CP_ERROR_FILE_WRITE;
+	}
+}
+
+
+/**
+ * @brief Writes a checkpoint with the state of the algorithm at a migration boundary. The file is written by a background thread, so the evolution is not paused
+ * @param subpops The subpopulations. Only their parents are stored
+ * @param nIndsFronts0 The number of individuals in the front 0 of each subpopulation
+ * @param selInstances The instances choosen as initial centroids
+ * @param nextMigration The index of the next global migration to be performed
+ * @param conf The structure with all configuration parameters
+ */
+void writeCheckpoint(const Individual *const subpops, const int *const nIndsFronts0, const int *const selInstances, const int nextMigration, const Config *const conf) {
+
+
+	/********** Snapshot of the state ***********/
+
+	int header[HEADER_SIZE];
+	header[MAGIC] = CHECKPOINT_MAGIC;
+	header[FEATURES] = conf -> nFeatures;
+	header[SUBPOPULATIONS] = conf -> nSubpopulations;
+	header[SUBPOPULATION_SIZE] = conf -> subpopulationSize;
+	header[CENTROIDS] = conf -> K;
+	header[NEXT_MIGRATION] = nextMigration;
+	header[RANDOM_STATE] = CP_RANDOM_STATE_SIZE;
+
+	size_t fixedSize = (HEADER_SIZE + conf -> K + conf -> nSubpopulations) * sizeof(int) + CP_RANDOM_STATE_SIZE;
+	std::vector<unsigned char> data(fixedSize + packedSize(conf -> worldSize, conf));
+	unsigned char *ptr = data.data();
+	memcpy(ptr, header, sizeof(header));
+	ptr += sizeof(header);
+	memcpy(ptr, selInstances, conf -> K * sizeof(int));
+	ptr += conf -> K * sizeof(int);
+	memcpy(ptr, nIndsFronts0, conf -> nSubpopulations * sizeof(int));
+	ptr += conf -> nSubpopulations * sizeof(int);
+
+	// Reactivating the current state stores the position of the generator inside it, without generating any number
+	setstate(randomState);
+	memcpy(ptr, randomState, CP_RANDOM_STATE_SIZE);
+	ptr += CP_RANDOM_STATE_SIZE;
+	data.resize(fixedSize + packSubpopulations(subpops, conf -> nSubpopulations, conf -> subpopulationSize, ptr, conf));
+
+
+	/********** The previous checkpoint must be finished before writing the new one ***********/
+
+	waitCheckpoint();
+	writer = std::thread(writeCheckpointFile, std::move(data), conf -> checkpointFileName);
+}
+
+
+/**
+ * @brief Waits until the last checkpoint has been completely written. If it could not be written, the execution is aborted
+ */
+void waitCheckpoint() {
+
+	if (writer.joinable()) {
+		writer.join();
+	}
+	check(writerError != NULL, "%s\n", writerError);
+}
+
+
+/**
+ * @brief Reads the whole checkpoint file and checks that it matches the current configuration
+ * @param conf The structure with all configuration parameters
+ * @return The checkpoint data
+ */
+std::vector<unsigned char> readCheckpointFile(const Config *const conf) {
+
+	std::fstream fCheckpoint(conf -> checkpointFileName.c_str(), std::fstream::in | std::fstream::binary);
+	check(!fCheckpoint.is_open(), "%s\n", CP_ERROR_FILE_OPEN);
+	fCheckpoint.seekg(0, std::fstream::end);
+	std::vector<unsigned char> data(fCheckpoint.tellg());
+	fCheckpoint.seekg(0);
+	fCheckpoint.read((char *) data.data(), data.size());
+	fCheckpoint.close();
+
+	int header[HEADER_SIZE];
+	size_t fixedSize = (HEADER_SIZE + conf -> K + conf -> nSubpopulations) * sizeof(int) + CP_RANDOM_STATE_SIZE;
+	check(data.size() < fixedSize, "%s\n", CP_ERROR_FILE_FORMAT);
+	memcpy(header, data.data(), sizeof(header));
+	check(header[MAGIC] != CHECKPOINT_MAGIC || header[FEATURES] != conf -> nFeatures || header[SUBPOPULATIONS] != conf -> nSubpopulations || header[SUBPOPULATION_SIZE] != conf -> subpopulationSize || header[CENTROIDS] != conf -> K || header[NEXT_MIGRATION] < 0 || header[NEXT_MIGRATION] >= conf -> nGlobalMigrations || header[RANDOM_STATE] != CP_RANDOM_STATE_SIZE, "%s\n", CP_ERROR_FILE_FORMAT);
+
+	return data;
+}
+
+
+/**
+ * @brief Reads the subpopulations from the latest checkpoint and restores the state of the random generator
+ * @param subpops The place where the subpopulations will be stored
+ * @param nIndsFronts0 The number of individuals in the front 0 of each subpopulation
+ * @param conf The structure with all configuration parameters
+ * @return The index of the next global migration to be performed
+ */
+int readCheckpoint(Individual *const subpops, int *const nIndsFronts0, const Config *const conf) {
+
+	std::vector<unsigned char> data = readCheckpointFile(conf);
+	int header[HEADER_SIZE];
+	memcpy(header, data.data(), sizeof(header));
+	const unsigned char *ptr = data.data() + sizeof(header) + conf -> K * sizeof(int);
+	memcpy(nIndsFronts0, ptr, conf -> nSubpopulations * sizeof(int));
+	ptr += conf -> nSubpopulations * sizeof(int);
+	for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
+		check(nIndsFronts0[sp] < 0 || nIndsFronts0[sp] > conf -> subpopulationSize, "%s\n", CP_ERROR_FILE_FORMAT);
+	}
+	const unsigned char *savedRandomState = ptr;
+	ptr += CP_RANDOM_STATE_SIZE;
+
+	// Nothing is unpacked until the whole packed world is known to fit in the file and in the subpopulations
+	size_t packedBytes = data.size() - (ptr - data.data());
+	check(!checkPackedSubpopulations(ptr, packedBytes, conf -> nSubpopulations, conf -> subpopulationSize, conf), "%s\n", CP_ERROR_FILE_FORMAT);
+	unpackSubpopulations(ptr, subpops, conf);
+
+	// The random generator continues from the state that it had when the checkpoint was written. The OpenMP threads share it, so the resumed execution does not reproduce the interrupted one
+	randomState = (randomState == randomStates[0]) ? randomStates[1] : randomStates[0];
+	memcpy(randomState, savedRandomState, CP_RANDOM_STATE_SIZE);
+	setstate(randomState);
+	return header[NEXT_MIGRATION];
+}
+
+
+/**
+ * @brief Reads the initial centroids from the latest checkpoint
+ * @param conf The structure with all configuration parameters
+ * @return The instances choosen as initial centroids
+ */
+int* readCheckpointCentroids(const Config *const conf) {
+
+	std::vector<unsigned char> data = readCheckpointFile(conf);
+	int *selInstances = new int[conf -> K];
+	memcpy(selInstances, data.data() + HEADER_SIZE * sizeof(int), conf -> K * sizeof(int));
+	for (int k = 0; k < conf -> K; ++k) {
+		check(selInstances[k] < 0 || selInstances[k] >= conf -> trNInstances, "%s\n", CP_ERROR_FILE_FORMAT);
+	}
+	return selInstances;
+}
@@ -8,6 +8,7 @@
 /********************************* Includes *******************************/
 
 #include "clUtils.h"
+#include <algorithm> // std::max
 #include <string>
 
 /********************************* Methods ********************************/
@@ -23,11 +24,27 @@ CLDevice::~CLDevice() {
 		clReleaseContext(this -> context);
 		clReleaseCommandQueue(this -> commandQueue);
 		clReleaseKernel(this -> kernel);
-		clReleaseMemObject(this -> objTrDataBase);
+		clReleaseKernel(this -> kernelColumns);
+		clReleaseMemObject(this -> objColumns);
+		if (this -> objColumnsTrDataBase != NULL) {
+			clReleaseMemObject(this -> objColumnsTrDataBase);
+		}
 		clReleaseMemObject(this -> objTransposedTrDataBase);
 		clReleaseMemObject(this -> objSelInstances);
 		clReleaseMemObject(this -> objSubpopulations);
+
+		if (this -> kernelSurvivors != NULL) {
+			clReleaseKernel(this -> kernelCrossover);
+			clReleaseKernel(this -> kernelNormalize);
+			clReleaseKernel(this -> kernelSurvivors);
+			clReleaseMemObject(this -> objSurvivors);
+			clReleaseMemObject(this -> objNChildren);
+			clReleaseMemObject(this -> objNIndsFront0);
+		}
 	}
+
+	delete this -> quantizedTrDataBase;
+	delete this -> sparseTrDataBase;
 }
 
 
@@ -53,7 +70,7 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 
 	// Others variables
 	auto allDevices = getAllDevices();
-	CLDevice *devices = new CLDevice[conf -> nDevices + (conf -> ompThreads > 0)];
+	CLDevice *devices = new CLDevice[conf -> nDevices + (conf -> ompThreads > 0)]();
 
 	for (int dev = 0; dev < conf -> nDevices; ++dev) {
 
@@ -83,6 +100,12 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 				long int maxMemory;
 				check(clGetDeviceInfo(devices[dev].device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(long int), &maxMemory, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXMEM);
 
+				// The survivors selection caches the fitness, crowding and rank of the whole family
+				if (conf -> deviceResident) {
+					long int residentMemory = conf -> familySize * (3 * sizeof(cl_float) + sizeof(cl_int) + sizeof(cl_uchar)) + sizeof(cl_int);
+					usedMemory = std::max(usedMemory, residentMemory);
+				}
+
 				// Avoid exceeding the maximum local memory available. 1024 bytes of margin
 				check(usedMemory > maxMemory - 1024, "%s:\n\tMax memory: %ld bytes\n\tAllow memory: %ld bytes\n\tUsed memory: %ld bytes\n", CL_ERROR_DEVICE_LOCALMEM, maxMemory, maxMemory - 1024, usedMemory);
 
@@ -119,8 +142,8 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 				check(status != CL_SUCCESS, "%s\n", CL_ERROR_PROGRAM_BUILD);
 
 				// Build program for the device in the context
-				char buildOptions[196];
-				sprintf(buildOptions, "-I include -D N_INSTANCES=%d -D N_FEATURES=%d -D N_OBJECTIVES=%d -D K=%d -D MAX_ITER_KMEANS=%d", conf -> trNInstances, conf -> nFeatures, conf -> nObjectives, conf -> K, conf -> maxIterKmeans);
+				char buildOptions[320];
+				sprintf(buildOptions, "-I include -D N_INSTANCES=%d -D N_FEATURES=%d -D N_OBJECTIVES=%d -D K=%d -D MAX_ITER_KMEANS=%d -D SUBPOP_SIZE=%d -D FAMILY_SIZE=%d -D POOL_SIZE=%d -D TOUR_SIZE=%d", conf -> trNInstances, conf -> nFeatures, conf -> nObjectives, conf -> K, conf -> maxIterKmeans, conf -> subpopulationSize, conf -> familySize, conf -> poolSize, conf -> tourSize);
 				if (clBuildProgram(program, 1, &(devices[dev].device), buildOptions, 0, 0) != CL_SUCCESS) {
 					char buffer[4096];
 					fprintf(stderr, "Error: Could not build the program\n");
@@ -132,6 +155,19 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 				const char *kernelName = (devices[dev].deviceType == CL_DEVICE_TYPE_GPU) ? "kmeansGPU" : "";
 				devices[dev].kernel = clCreateKernel(program, kernelName, &status);
 				check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_BUILD);
+				devices[dev].kernelColumns = clCreateKernel(program, "gatherColumnsGPU", &status);
+				check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_BUILD);
+
+				// The genetic operators are only executed on GPUs
+				devices[dev].kernelSurvivors = NULL;
+				bool resident = conf -> deviceResident && devices[dev].deviceType == CL_DEVICE_TYPE_GPU;
+				if (resident) {
+					cl_int statusCrossover, statusNormalize;
+					devices[dev].kernelCrossover = clCreateKernel(program, "crossoverGPU", &statusCrossover);
+					devices[dev].kernelNormalize = clCreateKernel(program, "normalizeFitnessGPU", &statusNormalize);
+					devices[dev].kernelSurvivors = clCreateKernel(program, "survivorsGPU", &status);
+					check(statusCrossover != CL_SUCCESS || statusNormalize != CL_SUCCESS || status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_RESIDENT);
+				}
 
 
 				/******* Work-items *******/
@@ -143,16 +179,20 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 
 				/******* Create and write the databases and centroids buffers. Create the subpopulations buffer. Set kernel arguments *******/
 
-				// Create buffers
-				devices[dev].objSubpopulations = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, conf -> familySize * sizeof(Individual), 0, &status);
+				// Create buffers. The children of all subpopulations are evaluated at once in batched mode
+				int maxIndividuals = (conf -> batchIslands && conf -> mpiSize == 1) ? std::max(conf -> familySize, conf -> worldSize) : conf -> familySize;
+				devices[dev].objSubpopulations = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, maxIndividuals * deviceIndividualSize(conf), 0, &status);
 				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_SUBPOPS);
 
-				devices[dev].objTrDataBase = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), 0, &status);
-				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_TRDB);
-
 				devices[dev].objTransposedTrDataBase = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), 0, &status);
 				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_TTRDB);
 
+				// Only the transposed database is kept on the device. The columns used by each batch are compacted from it into a buffer which grows with the largest set of columns
+				devices[dev].objColumns = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> nFeatures * sizeof(cl_int), 0, &status);
+				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_COLUMNS);
+				devices[dev].objColumnsTrDataBase = NULL;
+				devices[dev].columnsCapacity = 0;
+
 				devices[dev].objSelInstances = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> K * sizeof(cl_int), 0, &status);
 				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_CENTROIDS);
 
@@ -161,12 +201,32 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 
 				check(clSetKernelArg(devices[dev].kernel, 1, sizeof(cl_mem), (void *)&(devices[dev].objSelInstances)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT2);
 
-				check(clSetKernelArg(devices[dev].kernel, 2, sizeof(cl_mem), (void *)&(devices[dev].objTrDataBase)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT3);
-
-				check(clSetKernelArg(devices[dev].kernel, 5, sizeof(cl_mem), (void *)&(devices[dev].objTransposedTrDataBase)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT6);
+				check(clSetKernelArg(devices[dev].kernel, 2, sizeof(cl_mem), (void *)&(devices[dev].objColumns)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT3);
+
+				status = clSetKernelArg(devices[dev].kernelColumns, 0, sizeof(cl_mem), (void *)&(devices[dev].objTransposedTrDataBase));
+				status |= clSetKernelArg(devices[dev].kernelColumns, 1, sizeof(cl_mem), (void *)&(devices[dev].objColumns));
+				check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT_COLUMNS);
+
+				// Buffers and arguments of the genetic operators
+				if (resident) {
+					cl_int statusSurvivors, statusNChildren;
+					devices[dev].objSurvivors = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, conf -> subpopulationSize * deviceIndividualSize(conf), 0, &statusSurvivors);
+					devices[dev].objNChildren = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, sizeof(cl_int), 0, &statusNChildren);
+					devices[dev].objNIndsFront0 = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, sizeof(cl_int), 0, &status);
+					check(statusSurvivors != CL_SUCCESS || statusNChildren != CL_SUCCESS || status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_RESIDENT);
+
+					status = clSetKernelArg(devices[dev].kernelCrossover, 0, sizeof(cl_mem), (void *)&(devices[dev].objSubpopulations));
+					status |= clSetKernelArg(devices[dev].kernelCrossover, 1, sizeof(cl_mem), (void *)&(devices[dev].objNChildren));
+					status |= clSetKernelArg(devices[dev].kernelNormalize, 0, sizeof(cl_mem), (void *)&(devices[dev].objSubpopulations));
+					status |= clSetKernelArg(devices[dev].kernelNormalize, 1, sizeof(cl_mem), (void *)&(devices[dev].objNChildren));
+					status |= clSetKernelArg(devices[dev].kernelSurvivors, 0, sizeof(cl_mem), (void *)&(devices[dev].objSubpopulations));
+					status |= clSetKernelArg(devices[dev].kernelSurvivors, 1, sizeof(cl_mem), (void *)&(devices[dev].objSurvivors));
+					status |= clSetKernelArg(devices[dev].kernelSurvivors, 2, sizeof(cl_mem), (void *)&(devices[dev].objNChildren));
+					status |= clSetKernelArg(devices[dev].kernelSurvivors, 3, sizeof(cl_mem), (void *)&(devices[dev].objNIndsFront0));
+					check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT_RESIDENT);
+				}
 
 				// Write buffers
-				check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objTrDataBase, CL_FALSE, 0, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), trDataBase, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_TRDB);
 				check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objSelInstances, CL_FALSE, 0, conf -> K * sizeof(cl_int), selInstances, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_CENTROIDS);
 				check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objTransposedTrDataBase, CL_FALSE, 0, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), transposedTrDataBase, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_TTRDB);
 
@@ -188,6 +248,10 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 	if (conf -> ompThreads > 0) {
 		devices[conf -> nDevices].deviceType = CL_DEVICE_TYPE_CPU;
 		devices[conf -> nDevices].computeUnits = conf -> ompThreads;
+		devices[conf -> nDevices].quantizedTrDataBase = (conf -> trQuantize) ? quantizeDataBase(trDataBase, conf) : NULL;
+
+		// The sparse database is only kept by the CPU device, so each process reads it by itself
+		devices[conf -> nDevices].sparseTrDataBase = (conf -> trSparse) ? readSparseDataBase(conf) : NULL;
 		++(conf -> nDevices);
 	}
 
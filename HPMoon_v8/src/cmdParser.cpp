@@ -260,7 +260,7 @@ void CmdParser::printHelp() {
 template<> char* CmdParser::getValue(const char *const arg) {
 
 	std::string aux = (this -> find(arg)) ? this -> arguments.find(arg) -> second.getValue() : "";
-	char *value = new char[aux.length()];
+	char *value = new char[aux.length() + 1];
 	strcpy(value, aux.c_str());
 	return (aux.empty()) ? NULL : value;
 }
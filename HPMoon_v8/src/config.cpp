@@ -7,6 +7,7 @@
 
 /********************************* Includes *******************************/
 
+#include "bd.h"
 #include "clUtils.h"
 #include "cmdParser.h"
 #include "tinyxml2.h"
@@ -35,12 +36,17 @@ Config::~Config() {
  * @brief The constructor with parameters
  * @param argc Number of arguments
  * @param argv The command-line parameters
+ * @param rank The rank of the process. If it is negative, the rank in "MPI_COMM_WORLD" is used
+ * @param size The number of processes. If it is negative, the size of "MPI_COMM_WORLD" is used
  * @return An object containing all configuration parameters
  */
-Config::Config(const int argc, const char **argv) {
+Config::Config(const int argc, const char **argv, int rank, int size) {
 
-	int rank = MPI::COMM_WORLD.Get_rank();
-	int size = MPI::COMM_WORLD.Get_size();
+	int worldRank, worldSize;
+	MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+	rank = (rank < 0) ? worldRank : rank;
+	size = (size < 0) ? worldSize : size;
 
 
 	/************ Init the parser ***********/
@@ -64,10 +70,24 @@ Config::Config(const int argc, const char **argv) {
 	parser.addArg("-plotdata", true, "Name of the file containing the fitness of the individuals in the first Pareto front."); // Gnuplot data
 	parser.addArg("-plotsrc", true, "Name of the file containing the gnuplot code for data display."); // Gnuplot code
 	parser.addArg("-plotimg", true, "Name of the file containing the image with the data (graphic)."); // Gnuplot image
+	parser.addArg("-res", true, "Name of the binary file where the final Pareto front is written with the selected features of each individual. It can be printed with \"hpmoon-results\"."); // Results file
+	parser.addArg("-resworld", false, "If the parents of all subpopulations must also be written into the results file."); // Results of the world
 	parser.addArg("-trni", true, "Maximum number of instances to be taken from the training database."); // Maximum number of training instances
-	parser.addArg("-trdb", true, "Name of the file containing the training database."); // Training database
+	parser.addArg("-trdb", true, "Name of the file containing the training database. It can be stored as text, in the binary format of \"hpmoon-convert\" or as sparse text, whose instances are lists of \"feature:value\" pairs (features numbered from 0)."); // Training database
 	parser.addArg("-trnorm", false, "If the training database must be normalized or not."); // Normalization of the training database
+	parser.addArg("-trooc", false, "If the training database must be streamed from its memory-mapped binary file instead of being loaded in memory (only CPU threads can evaluate)."); // Out-of-core training database
+	parser.addArg("-trquant", false, "If the CPU threads must evaluate the individuals over an 8-bit quantized copy of the training database, which should be normalized (only CPU threads can evaluate). The fitness error is reported at the end."); // Quantized training database
+	parser.addArg("-trstream", false, "If the lines appended to the text training database while the algorithm runs must be added to the database at each migration, up to the maximum number of instances (only a single MPI process with CPU threads). The parents are evaluated again when the database grows."); // Streaming training database
 	parser.addArg("-ts", true, "Number of individuals competing in the tournament."); // Tournament size
+	parser.addArg("-steady", false, "If the subpopulations must be evolved in asynchronous steady-state mode."); // Steady-state evolution
+	parser.addArg("-batch", false, "If the children of all subpopulations must be evaluated in a single batch (only for a single MPI process)."); // Batched evaluation of the subpopulations
+	parser.addArg("-resident", false, "If the genetic operators must also be executed on the GPU which evolves each subpopulation."); // Device-resident evolution
+	parser.addArg("-mt", true, "Migration topology: \"master\", \"ring\", \"torus\" or \"random\" (only for several MPI processes)."); // Migration topology
+	parser.addArg("-cp", true, "Name of the file where a checkpoint is written in each migration (only with the \"master\" migration topology)."); // Checkpoint file
+	parser.addArg("-resume", false, "If the execution must be resumed from the latest checkpoint."); // Resume from the checkpoint
+	parser.addArg("-mw", false, "If the master must also evolve subpopulations over its own devices (only with the \"master\" migration topology). The first entry of \"Devices\" is then used by the master."); // Master also works
+	parser.addArg("-sim", true, "Number of workers simulated by threads of a single process, which exchange the subpopulations in memory instead of using MPI (only for a single MPI process)."); // Simulated workers
+	parser.addArg("-verify", false, "If the final Pareto front must be evaluated again on the OpenCL devices and on the CPU, so the fitness error of the devices is reported at the end (only when the master process has devices)."); // Verification of the devices
 	parser.addArg("-ke", true, "Name of the file containing the kernels with the OpenCL code."); // Kernels
 
 	// Parse and check the missing arguments
@@ -81,14 +101,14 @@ Config::Config(const int argc, const char **argv) {
 		if (rank == 0) {
 			parser.printHelp();
 		}
-		MPI::Finalize();
+		MPI_Finalize();
 		exit(0);
 	}
 
 	// List OpenCL devices
 	if (parser.isSet("-l")) {
 		listDevices(rank);
-		MPI::Finalize();
+		MPI_Finalize();
 		exit(0);
 	}
 
@@ -165,6 +185,25 @@ Config::Config(const int argc, const char **argv) {
 	this -> imageFileName = (parser.isSet("-plotimg")) ? parser.getValue<char*>("-plotimg") : root -> FirstChildElement("ImageFileName") -> GetText();
 
 
+	////////////////////// -res value
+	if (parser.isSet("-res")) {
+		this -> resultsFileName = parser.getValue<char*>("-res");
+	}
+	else {
+		const char *text = root -> FirstChildElement("ResultsFileName") -> GetText();
+		this -> resultsFileName = (text == NULL) ? "" : text;
+	}
+
+
+	////////////////////// -resworld value
+	if (parser.isSet("-resworld")) {
+		this -> resultsWorld = true;
+	}
+	else {
+		root -> FirstChildElement("ResultsWorld") -> QueryBoolText(&(this -> resultsWorld));
+	}
+
+
 	////////////////////// -trni value
 	XMLElement *parent = root -> FirstChildElement("TrDatabase");
 	if (parser.isSet("-trni")) {
@@ -187,6 +226,33 @@ Config::Config(const int argc, const char **argv) {
 	}
 
 
+	////////////////////// -trooc value
+	if (parser.isSet("-trooc")) {
+		this -> trOutOfCore = true;
+	}
+	else {
+		parent -> FirstChildElement("OutOfCore") -> QueryBoolText(&(this -> trOutOfCore));
+	}
+
+
+	////////////////////// -trquant value
+	if (parser.isSet("-trquant")) {
+		this -> trQuantize = true;
+	}
+	else {
+		parent -> FirstChildElement("Quantize") -> QueryBoolText(&(this -> trQuantize));
+	}
+
+
+	////////////////////// -trstream value
+	if (parser.isSet("-trstream")) {
+		this -> trStream = true;
+	}
+	else {
+		parent -> FirstChildElement("Stream") -> QueryBoolText(&(this -> trStream));
+	}
+
+
 	////////////////////// -ts value
 	if (parser.isSet("-ts")) {
 		this -> tourSize = parser.getValue<int>("-ts");
@@ -196,11 +262,103 @@ Config::Config(const int argc, const char **argv) {
 	}
 	check(this -> tourSize < 2 || this -> tourSize > this -> subpopulationSize, "%s\n", CFG_ERROR_TOURNAMENT_SIZE);
 
-	if (rank > 0 || (rank == 0 && size == 1)) {
+
+	////////////////////// -steady value
+	if (parser.isSet("-steady")) {
+		this -> steadyState = true;
+	}
+	else {
+		root -> FirstChildElement("SteadyState") -> QueryBoolText(&(this -> steadyState));
+	}
+
+
+	////////////////////// -batch value
+	if (parser.isSet("-batch")) {
+		this -> batchIslands = true;
+	}
+	else {
+		root -> FirstChildElement("BatchIslands") -> QueryBoolText(&(this -> batchIslands));
+	}
+	check(this -> batchIslands && this -> steadyState, "%s\n", CFG_ERROR_BATCH_STEADY);
+
+
+	////////////////////// -resident value
+	if (parser.isSet("-resident")) {
+		this -> deviceResident = true;
+	}
+	else {
+		root -> FirstChildElement("DeviceResident") -> QueryBoolText(&(this -> deviceResident));
+	}
+	check(this -> deviceResident && (this -> steadyState || this -> batchIslands), "%s\n", CFG_ERROR_RESIDENT_MODE);
+
+
+	////////////////////// -mt value
+	this -> migrationTopology = (parser.isSet("-mt")) ? parser.getValue<char*>("-mt") : root -> FirstChildElement("MigrationTopology") -> GetText();
+	check(this -> migrationTopology != "master" && this -> migrationTopology != "ring" && this -> migrationTopology != "torus" && this -> migrationTopology != "random", "%s\n", CFG_ERROR_TOPOLOGY);
+
+
+	////////////////////// -cp value
+	if (parser.isSet("-cp")) {
+		this -> checkpointFileName = parser.getValue<char*>("-cp");
+	}
+	else {
+		const char *text = root -> FirstChildElement("CheckpointFileName") -> GetText();
+		this -> checkpointFileName = (text == NULL) ? "" : text;
+	}
+	check(!this -> checkpointFileName.empty() && this -> migrationTopology != "master" && size > 1, "%s\n", CFG_ERROR_CHECKPOINT_TOPOLOGY);
+
+
+	////////////////////// -resume value
+	if (parser.isSet("-resume")) {
+		this -> resume = true;
+	}
+	else {
+		root -> FirstChildElement("Resume") -> QueryBoolText(&(this -> resume));
+	}
+	check(this -> resume && this -> checkpointFileName.empty(), "%s\n", CFG_ERROR_RESUME);
+
+
+	////////////////////// -mw value
+	if (parser.isSet("-mw")) {
+		this -> masterWorker = true;
+	}
+	else {
+		root -> FirstChildElement("MasterWorker") -> QueryBoolText(&(this -> masterWorker));
+	}
+	this -> masterWorker = this -> masterWorker && size > 1;
+	check(this -> masterWorker && this -> migrationTopology != "master", "%s\n", CFG_ERROR_MASTER_WORKER);
+
+
+	////////////////////// -sim value
+	if (parser.isSet("-sim")) {
+		this -> simWorkers = parser.getValue<int>("-sim");
+	}
+	else {
+		root -> FirstChildElement("SimulatedWorkers") -> QueryIntText(&(this -> simWorkers));
+	}
+	check(this -> simWorkers < 0 || (this -> simWorkers > 0 && worldSize > 1), "%s\n", CFG_ERROR_SIMULATION);
+
+
+	////////////////////// -verify value
+	if (parser.isSet("-verify")) {
+		this -> verifyDevices = true;
+	}
+	else {
+		root -> FirstChildElement("VerifyDevices") -> QueryBoolText(&(this -> verifyDevices));
+	}
+
+	// The master does not get any device unless it also evolves subpopulations
+	this -> nDevices = 0;
+	this -> ompThreads = 0;
+	this -> devices = NULL;
+	this -> computeUnits = NULL;
+	this -> wiLocal = NULL;
+	if (rank > 0 || size == 1 || this -> masterWorker) {
 
 		////////////////////// Devices number
+		// When the master also works, it uses the first entry and each worker the next one of the usual
 		parent = root -> FirstChildElement("Devices") -> FirstChildElement();
-		for (int i = 1; i < rank; ++i) {
+		for (int i = 1; i < rank + this -> masterWorker; ++i) {
 			parent = parent -> NextSiblingElement("NDevices");
 			check(parent == NULL, "%s\n", CFG_ERROR_OPENCL_INFO);
 		}
@@ -234,6 +392,8 @@ Config::Config(const int argc, const char **argv) {
 		////////////////////// CPU threads value
 		parent -> NextSiblingElement("CpuThreads") -> QueryIntText(&(this -> ompThreads));
 		check(this -> ompThreads < 0 || (this -> ompThreads == 0 && this -> nDevices == 0), "%s\n", CFG_ERROR_THREADS_MIN);
+		check(this -> trOutOfCore && this -> nDevices > 0, "%s\n", CFG_ERROR_OUT_OF_CORE);
+		check(this -> trQuantize && (this -> nDevices > 0 || this -> trOutOfCore), "%s\n", CFG_ERROR_QUANTIZE);
 	}
 
 
@@ -263,9 +423,16 @@ Config::Config(const int argc, const char **argv) {
 	this -> totalIndividuals = this -> worldSize << 1;
 
 
-	////////////////////// Number of features of the training database
-	this -> nFeatures = N_FEATURES;
-	check(N_FEATURES < 4, "%s\n", CFG_ERROR_FEATURES_MIN);
+	////////////////////// Number of features and format of the training database. They are read from the database by the master and shared with the rest of processes
+	if (worldRank == 0) {
+		this -> trSparse = isSparseDataBase(this);
+		this -> nFeatures = getDataBaseFeatures(this);
+	}
+	MPI_Bcast(&(this -> trSparse), 1, MPI_CXX_BOOL, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&(this -> nFeatures), 1, MPI_INT, 0, MPI_COMM_WORLD);
+	check(this -> nFeatures < 4, "%s\n", CFG_ERROR_FEATURES_MIN);
+	check(this -> trSparse && (this -> nDevices > 0 || this -> trOutOfCore || this -> trQuantize), "%s\n", CFG_ERROR_SPARSE);
+	check(this -> trStream && (worldSize > 1 || this -> simWorkers > 0 || this -> nDevices > 0 || this -> trOutOfCore || this -> trQuantize || this -> trSparse), "%s\n", CFG_ERROR_STREAM);
 
 
 	////////////////////// Number of objectives
@@ -320,9 +487,11 @@ void check(const bool cond, const char *const format, ...) {
 	if (cond) {
 		va_list args;
 		va_start(args, format);
-		fprintf(stderr, "Process %d: ", MPI::COMM_WORLD.Get_rank());
+		int rank;
+		MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+		fprintf(stderr, "Process %d: ", rank);
 		vfprintf(stderr, format, args);
 		va_end(args);
-		MPI::COMM_WORLD.Abort(-1);
+		MPI_Abort(MPI_COMM_WORLD, -1);
 	}
 }
@@ -0,0 +1,61 @@
+/**
+ * @file convert.cpp
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief Tool which converts a training database from text to the binary columnar format
+ *
+ * The binary databases are mapped in memory by HPMoon, so they are loaded without parsing or transposing them
+ */
+
+/********************************* Includes ********************************/
+
+#include "bd.h"
+#include "cmdParser.h"
+
+
+/**
+ * @brief Main program
+ * @param argc The number of arguments of the program
+ * @param argv Arguments of the program
+ */
+int main(const int argc, const char **argv) {
+
+
+	/********** Initialize the MPI environment. It is only used to report the errors ***********/
+
+	MPI_Init(NULL, NULL);
+
+
+	/********** Get the arguments from the command-line ***********/
+
+	CmdParser parser("Converts a training database from text to the binary columnar format read by HPMoon.", "./bin/hpmoon-convert -i TEXT_FILE -o BINARY_FILE [-norm]", "Cluster HPMoon (C) 2018 v8.0");
+	parser.addExample("./bin/hpmoon-convert -i \"db/TRdata.txt\" -o \"db/TRdata.hmdb\"");
+	parser.addExample("./bin/hpmoon-convert -i \"db/TRdata.txt\" -o \"db/TRdata.hmdb\" -norm");
+	parser.addArg("-h", false, "Display usage instructions."); // Display help
+	parser.addArg("-i", true, "Name of the file containing the text database."); // Text database
+	parser.addArg("-o", true, "Name of the binary database file to be created."); // Binary database
+	parser.addArg("-norm", false, "Normalize the database using all its instances, so it is not normalized again when it is read."); // Normalization
+
+	check(!parser.parse(argv, argc), "%s\n", CFG_ERROR_PARSE_ARGUMENTS);
+	if (parser.isSet("-h")) {
+		parser.printHelp();
+		MPI_Finalize();
+		exit(0);
+	}
+	check(!parser.isSet("-i") || !parser.isSet("-o"), "%s\n", BD_ERROR_CONVERT_ARGUMENTS);
+
+
+	/********** Conversion ***********/
+
+	int nRows, nCols;
+	float *dataBase = readTextDataBase(parser.getValue<char*>("-i"), &nRows, &nCols);
+	if (parser.isSet("-norm")) {
+		normDataBase(dataBase, NULL, nRows, nCols);
+	}
+	writeBinaryDataBase(parser.getValue<char*>("-o"), dataBase, nRows, nCols, parser.isSet("-norm"));
+	fprintf(stdout, "%d instances with %d features\n", nRows, nCols);
+	delete[] dataBase;
+
+	// Finish the MPI environment
+	MPI_Finalize();
+}
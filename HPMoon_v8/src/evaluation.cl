@@ -2,7 +2,7 @@
  * @file evaluation.cl
  * @author Juan José Escobar Pérez
  * @date 12/07/2015
- * @brief File with the necessary implementation for the K-means algorithm in OpenCL
+ * @brief File with the necessary implementation for the K-means algorithm and the genetic operators in OpenCL
  */
 
 /*********************************** Defines *********************************/
@@ -16,7 +16,7 @@ typedef struct Individual {
 	/**
 	 * @brief Vector denoting the selected features
 	 *
-	 * Values: Zeros or ones
+	 * Values: Zeros or ones. The host copies the individuals with this layout, which depends on "N_FEATURES"
 	 */
 	unsigned char chromosome[N_FEATURES];
 
@@ -29,6 +29,12 @@ typedef struct Individual {
 	float fitness[N_OBJECTIVES];
 
 
+	/**
+	 * @brief Objectives of the individual before being normalized
+	 */
+	float rawFitness[N_OBJECTIVES];
+
+
 	/**
 	 * @brief Crowding distance of the individual
 	 *
@@ -50,26 +56,97 @@ typedef struct Individual {
 
 } Individual;
 
+
+/**
+ * @brief Streams of the counter-based random number generator
+ */
+#define STREAM_SELECTION 0x00000000u
+#define STREAM_OPERATION 0x10000000u
+#define STREAM_CROSSOVER 0x20000000u
+#define STREAM_MUTATION 0x30000000u
+#define STREAM_EMPTY 0x40000000u
+
+/********************************* Functions ********************************/
+
+/**
+ * @brief Mixes the bits of a 32 bits integer
+ * @param x The integer
+ * @return The mixed integer
+ */
+uint mixBits(uint x) {
+
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+	return x;
+}
+
+
+/**
+ * @brief Counter-based random number generator. The same seed and counters always produce the same number, so no state must be kept between work-items or kernels
+ * @param seed The seed of the current generation
+ * @param stream The stream (purpose) of the number and its first counter
+ * @param counter The second counter
+ * @return A random unsigned integer
+ */
+uint randomUint(const uint seed, const uint stream, const uint counter) {
+
+	return mixBits(mixBits(mixBits(seed) ^ stream) ^ counter);
+}
+
+
+/**
+ * @brief Counter-based random number generator
+ * @param seed The seed of the current generation
+ * @param stream The stream (purpose) of the number and its first counter
+ * @param counter The second counter
+ * @return A random number between 0.0 and 1.0
+ */
+float randomFloat(const uint seed, const uint stream, const uint counter) {
+
+	return (randomUint(seed, stream, counter) >> 8) * (1.0f / 16777216.0f);
+}
+
 /********************************* OpenCL Kernels ********************************/
 
 
 /**
- * @brief Computes the K-means algorithm in a OpenCL GPU device
+ * @brief Copies the columns of the transposed training database selected by some individual of the batch into a compacted database, so the K-means kernel only streams the columns which are used
+ * @param transposedDataBase OpenCL object which contains the transposed training database. The object is stored in global memory
+ * @param columns OpenCL object which contains the features of the columns to be copied, in increasing order. The object is stored in global memory
+ * @param nColumns The number of columns to be copied
+ * @param columnsDataBase OpenCL object where the compacted columns are stored. The object is stored in global memory
+ */
+__kernel void gatherColumnsGPU(__global float *restrict transposedDataBase, __global int *restrict columns, const int nColumns, __global float *restrict columnsDataBase) {
+
+	for (int x = get_global_id(0); x < nColumns * N_INSTANCES; x += get_global_size(0)) {
+		int c = x / N_INSTANCES;
+		int i = x - (c * N_INSTANCES); // x % N_INSTANCES
+		columnsDataBase[x] = transposedDataBase[(N_INSTANCES * columns[c]) + i];
+	}
+}
+
+
+/**
+ * @brief Computes the K-means algorithm in a OpenCL GPU device. Only the columns of the training database selected by some individual of the batch are used, so the chromosomes are remapped to them
  * @param subpop OpenCL object which contains the current subpopulation. The object is stored in global memory
  * @param selInstances OpenCL object which contains the instances choosen as initial centroids. The object is stored in constant memory
- * @param trDataBase OpenCL object which contains the training database. The object is stored in global memory
+ * @param columns OpenCL object which contains the feature of each column of "transposedDataBase", in increasing order. The object is stored in global memory
  * @param begin The first individual to be evaluated
  * @param end The "end-1" position is the last individual to be evaluated
- * @param transposedDataBase OpenCL object which contains the transposed training database. The object is stored in global memory
+ * @param transposedDataBase OpenCL object which contains the columns of the transposed training database. The object is stored in global memory
+ * @param nColumns The number of columns of "transposedDataBase"
  */
-__kernel void kmeansGPU(__global struct Individual *subpop, __constant int *restrict selInstances, __global float *restrict trDataBase, const int begin, const int end, __global float *restrict transposedDataBase) {
+__kernel void kmeansGPU(__global struct Individual *subpop, __constant int *restrict selInstances, __global int *restrict columns, const int begin, const int end, __global float *restrict transposedDataBase, const int nColumns) {
 
 	uint localId = get_local_id(0);
 	uint localSize = get_local_size(0);
 	uint groupId = get_group_id(0);
 	uint numGroups = get_num_groups(0);
 
-	const int totalCoord = K * N_FEATURES;
+	const int totalCoord = K * nColumns;
 
 	// The individual is cached into local memory to improve performance
 	__local uchar chromosome[N_FEATURES];
@@ -78,20 +155,26 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 	__local float distCentroids[N_INSTANCES];
 	__local int samples_in_k[K];
 
-	event_t eventInd;
-	event_t eventCentr;
-
 
 	// Each work-group compute an individual (master-slave as a deck algorithm)
 	for (int ind = begin + groupId; ind < end; ind += numGroups) {
 
+		// Empty individuals are not evaluated (unused children in the device-resident mode)
+		if (subpop[ind].nSelFeatures == 0) {
+			continue;
+		}
+
 		// The centroids will have the selected features of the individual
-		for (int k = 0; k < K; ++k) {
-			async_work_group_copy(centroids_l + (N_FEATURES * k), trDataBase + (selInstances[k] * N_FEATURES), N_FEATURES, eventCentr);
+		for (int kc = localId; kc < totalCoord; kc += localSize) {
+			int k = kc / nColumns;
+			int c = kc - (k * nColumns); // kc % nColumns
+			centroids_l[kc] = transposedDataBase[(N_INSTANCES * c) + selInstances[k]];
 		}
 
-		// The individual is cached to local memory for improve performance
-		eventInd = async_work_group_copy(chromosome, subpop[ind].chromosome, N_FEATURES, 0);
+		// The individual is remapped to the columns and cached to local memory for improve performance
+		for (int c = localId; c < nColumns; c += localSize) {
+			chromosome[c] = subpop[ind].chromosome[columns[c]];
+		}
 
 		// Initialize the mapping table
 		for (int i = localId; i < N_INSTANCES; i += localSize) {
@@ -101,8 +184,7 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 		//converged = false;
 
 		// Syncpoint
-		wait_group_events(1, &eventInd);
-		wait_group_events(1, &eventCentr);
+		barrier(CLK_LOCAL_MEM_FENCE);
 
 
 		/******************** Convergence process *********************/
@@ -123,11 +205,11 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 			for (int i = localId; i < N_INSTANCES; i += localSize) {
 				float minDist = INFINITY;
 				int selectCentroid;
-				for (int k = 0, posCentr = 0; k < K; ++k, posCentr += N_FEATURES) {
+				for (int k = 0, posCentr = 0; k < K; ++k, posCentr += nColumns) {
 					float dist = 0.0f;
-					for (int f = 0; f < N_FEATURES; ++f) {
-						if (chromosome[f]) {
-							float dif = transposedDataBase[(N_INSTANCES * f) + i] - centroids_l[posCentr + f];
+					for (int c = 0; c < nColumns; ++c) {
+						if (chromosome[c]) {
+							float dif = transposedDataBase[(N_INSTANCES * c) + i] - centroids_l[posCentr + c];
 							dist = mad(dif, dif, dist);
 						}
 					}
@@ -150,15 +232,15 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 			barrier(CLK_LOCAL_MEM_FENCE);
 
 			// Update the position of the centroids
-			for (int kf = localId; kf < totalCoord; kf += localSize) {
-				int k = kf / N_FEATURES;
-				int f = kf - (k * N_FEATURES); // kf % N_FEATURES
-				if (chromosome[f] && samples_in_k[k] > 0) {
+			for (int kc = localId; kc < totalCoord; kc += localSize) {
+				int k = kc / nColumns;
+				int c = kc - (k * nColumns); // kc % nColumns
+				if (chromosome[c] && samples_in_k[k] > 0) {
 					float sum = 0.0f;
 					for (int i = 0; i < N_INSTANCES; ++i) {
-						sum += (mapping[i] == k) ? trDataBase[(N_FEATURES * i) + f] : 0;
+						sum += (mapping[i] == k) ? transposedDataBase[(N_INSTANCES * c) + i] : 0;
 					}
-					centroids_l[kf] = sum / samples_in_k[k];
+					centroids_l[kc] = sum / samples_in_k[k];
 				}
 			}
 
@@ -179,12 +261,12 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 			}
 
 			// Inter-cluster
-			for (int posCentr = 0; posCentr < totalCoord; posCentr += N_FEATURES) {
-				for (int i = posCentr + N_FEATURES; i < totalCoord; i += N_FEATURES) {
+			for (int posCentr = 0; posCentr < totalCoord; posCentr += nColumns) {
+				for (int i = posCentr + nColumns; i < totalCoord; i += nColumns) {
 					float sum = 0.0f;
-					for (int f = 0; f < N_FEATURES; ++f) {
-						if (chromosome[f]) {
-							sum += (centroids_l[posCentr + f] - centroids_l[i + f]) * (centroids_l[posCentr + f] - centroids_l[i + f]);
+					for (int c = 0; c < nColumns; ++c) {
+						if (chromosome[c]) {
+							sum += (centroids_l[posCentr + c] - centroids_l[i + c]) * (centroids_l[posCentr + c] - centroids_l[i + c]);
 						}
 					}
 					sumInter += sqrt(sum);
@@ -202,3 +284,310 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 		barrier(CLK_LOCAL_MEM_FENCE);
 	}
 }
+
+
+/**
+ * @brief Fills the mating pool by tournament and performs the uniform crossover and the mutation of one subpopulation in a single work-group. The children are stored in the right half of the subpopulation
+ * @param subpop OpenCL object which contains the current subpopulation, sorted by rank and crowding distance. The object is stored in global memory
+ * @param nChildren OpenCL object where the number of generated children is stored. The object is stored in global memory
+ * @param seed The seed of the random numbers for the current generation
+ */
+__kernel void crossoverGPU(__global struct Individual *subpop, __global int *nChildren, const uint seed) {
+
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+
+	__local int pool[POOL_SIZE];
+	__local int parent1[POOL_SIZE];
+	__local int parent2[POOL_SIZE];
+	__local int childOffset[POOL_SIZE + 1];
+	__local int nSelFeatures[SUBPOP_SIZE];
+
+
+	/******************** Fill the pool *********************/
+
+	// The individuals are sorted by rank and crowding distance. Therefore, lower index is better
+	for (int i = localId; i < POOL_SIZE; i += localSize) {
+		int best = SUBPOP_SIZE;
+		for (int j = 0; j < TOUR_SIZE; ++j) {
+			best = min(best, (int) (randomUint(seed, STREAM_SELECTION + i, j) % SUBPOP_SIZE));
+		}
+		pool[i] = best;
+	}
+
+	for (int i = localId; i < SUBPOP_SIZE; i += localSize) {
+		nSelFeatures[i] = 0;
+	}
+
+	// Syncpoint
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+
+	/******************** Choose the operations *********************/
+
+	// Each operation generates one or two children, so the position of the children is sequentially computed
+	if (localId == 0) {
+		int offset = 0;
+		for (int op = 0; op < POOL_SIZE; ++op) {
+			parent1[op] = pool[randomUint(seed, STREAM_OPERATION + op, 0) % POOL_SIZE];
+			parent2[op] = -1;
+			childOffset[op] = offset;
+
+			// 75% probability perform crossover. Avoid repeated parents
+			if (randomFloat(seed, STREAM_OPERATION + op, 1) < 0.75f) {
+				for (uint attempt = 2; attempt < 66 && parent2[op] < 0; ++attempt) {
+					int candidate = pool[randomUint(seed, STREAM_OPERATION + op, attempt) % POOL_SIZE];
+					parent2[op] = (candidate != parent1[op]) ? candidate : -1;
+				}
+			}
+			offset += (parent2[op] < 0) ? 1 : 2;
+		}
+		childOffset[POOL_SIZE] = offset;
+		*nChildren = offset;
+	}
+
+	// Syncpoint
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+
+	/******************** Crossover and mutation of each decision variable *********************/
+
+	for (int gen = localId; gen < POOL_SIZE * N_FEATURES; gen += localSize) {
+		int op = gen / N_FEATURES;
+		int f = gen - (op * N_FEATURES); // gen % N_FEATURES
+		int child = childOffset[op];
+		uchar gene1 = subpop[parent1[op]].chromosome[f];
+
+		// Uniform crossover. 50% probability perform copy the decision variable of the other parent
+		if (parent2[op] >= 0) {
+			uchar gene2 = subpop[parent2[op]].chromosome[f];
+			bool swap = (gene1 != gene2) && randomFloat(seed, STREAM_CROSSOVER + op, f) < 0.5f;
+			uchar gene = (swap) ? gene2 : gene1;
+			uchar gene2Child = (swap) ? gene1 : gene2;
+			subpop[SUBPOP_SIZE + child].chromosome[f] = gene;
+			subpop[SUBPOP_SIZE + child + 1].chromosome[f] = gene2Child;
+			if (gene) {
+				atomic_inc(&nSelFeatures[child]);
+			}
+			if (gene2Child) {
+				atomic_inc(&nSelFeatures[child + 1]);
+			}
+		}
+
+		// Random mutation. 10% probability perform mutation (gen level)
+		else {
+			uchar gene = gene1;
+			if (randomFloat(seed, STREAM_CROSSOVER + op, f) < 0.1f) {
+				gene = (randomFloat(seed, STREAM_MUTATION + op, f) > 0.01f) ? 0 : 1;
+			}
+			subpop[SUBPOP_SIZE + child].chromosome[f] = gene;
+			if (gene) {
+				atomic_inc(&nSelFeatures[child]);
+			}
+		}
+	}
+
+	// Syncpoint
+	barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);
+
+
+	/******************** Children initialization *********************/
+
+	// At least one decision variable must be set to "1". The unused children are left empty and they will not be evaluated
+	for (int c = localId; c < SUBPOP_SIZE; c += localSize) {
+		__global struct Individual *child = &subpop[SUBPOP_SIZE + c];
+		int nSel = 0;
+		if (c < childOffset[POOL_SIZE]) {
+			nSel = nSelFeatures[c];
+			if (nSel == 0) {
+				child -> chromosome[randomUint(seed, STREAM_EMPTY + c, 0) % N_FEATURES] = 1;
+				nSel = 1;
+			}
+		}
+
+		child -> nSelFeatures = nSel;
+		for (int obj = 0; obj < N_OBJECTIVES; ++obj) {
+			child -> fitness[obj] = 0.0f;
+		}
+		child -> crowding = 0.0f;
+		child -> rank = -1;
+	}
+}
+
+
+/**
+ * @brief Normalizes the fitness of the children of one subpopulation in a single work-group
+ * @param subpop OpenCL object which contains the current subpopulation. The object is stored in global memory
+ * @param nChildren OpenCL object which contains the number of children. The object is stored in global memory
+ */
+__kernel void normalizeFitnessGPU(__global struct Individual *subpop, __global int *nChildren) {
+
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+	int nIndividuals = *nChildren;
+	__global struct Individual *children = subpop + SUBPOP_SIZE;
+
+	__local float average[N_OBJECTIVES];
+	__local float stdDeviation[N_OBJECTIVES];
+
+	// Fitness vector average and standard deviation
+	if (localId == 0) {
+		for (int obj = 0; obj < N_OBJECTIVES; ++obj) {
+			float sum = 0.0f;
+			for (int i = 0; i < nIndividuals; ++i) {
+				sum += children[i].fitness[obj];
+			}
+			average[obj] = sum / nIndividuals;
+
+			float variance = 0.0f;
+			for (int i = 0; i < nIndividuals; ++i) {
+				variance += (children[i].fitness[obj] - average[obj]) * (children[i].fitness[obj] - average[obj]);
+			}
+			stdDeviation[obj] = sqrt(variance / (nIndividuals - 1));
+		}
+	}
+
+	// Syncpoint
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// Normalize a set of continuous values using SoftMax (based on the logistic function)
+	// The second objective is a maximization problem. x_new must be negative
+	// If all the values are equal (or there is only one child), they are placed in the middle of the range instead of dividing by zero
+	for (int i = localId; i < nIndividuals; i += localSize) {
+		for (int obj = 0; obj < N_OBJECTIVES; ++obj) {
+			float x_scaled = (stdDeviation[obj] > 0.0f) ? (children[i].fitness[obj] - average[obj]) / stdDeviation[obj] : 0.0f;
+			float x_new = 1.0f / (1.0f + exp(-x_scaled));
+			children[i].rawFitness[obj] = children[i].fitness[obj];
+			children[i].fitness[obj] = (obj == 1) ? -x_new : x_new;
+		}
+	}
+}
+
+
+/**
+ * @brief Sorts parents and children of one subpopulation by rank and crowding distance in a single work-group. The best individuals are kept as the parents of the next generation
+ * @param subpop OpenCL object which contains the current subpopulation. The object is stored in global memory
+ * @param survivors OpenCL object used to sort the survivors. The object is stored in global memory
+ * @param nChildren OpenCL object which contains the number of children. The object is stored in global memory
+ * @param nIndsFront0 OpenCL object where the number of individuals in the front 0 is stored. The object is stored in global memory
+ */
+__kernel void survivorsGPU(__global struct Individual *subpop, __global struct Individual *survivors, __global int *nChildren, __global int *nIndsFront0) {
+
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+	int nIndividuals = SUBPOP_SIZE + *nChildren;
+
+	__local float fitness0[FAMILY_SIZE];
+	__local float fitness1[FAMILY_SIZE];
+	__local float crowding[FAMILY_SIZE];
+	__local int rank[FAMILY_SIZE];
+	__local uchar inFront[FAMILY_SIZE];
+	__local int nAssigned;
+
+	for (int i = localId; i < nIndividuals; i += localSize) {
+		fitness0[i] = subpop[i].fitness[0];
+		fitness1[i] = subpop[i].fitness[1];
+		rank[i] = -1;
+	}
+	if (localId == 0) {
+		nAssigned = 0;
+	}
+
+	// Syncpoint
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+
+	/******************** Non-domination sort *********************/
+
+	// The non-dominated individuals among those which have not a rank yet form the next front
+	for (int front = 0; nAssigned < nIndividuals; ++front) {
+		for (int i = localId; i < nIndividuals; i += localSize) {
+			bool dominated = (rank[i] != -1);
+			for (int j = 0; j < nIndividuals && !dominated; ++j) {
+				dominated = rank[j] == -1 && fitness0[j] <= fitness0[i] && fitness1[j] <= fitness1[i] && (fitness0[j] < fitness0[i] || fitness1[j] < fitness1[i]);
+			}
+			inFront[i] = !dominated;
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		for (int i = localId; i < nIndividuals; i += localSize) {
+			if (inFront[i]) {
+				rank[i] = front;
+				atomic_inc(&nAssigned);
+			}
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+
+	/******************** Crowding distance *********************/
+
+	// The neighbours of each individual in its front are searched. Ties are broken by position
+	for (int i = localId; i < nIndividuals; i += localSize) {
+		float distance = 0.0f;
+		for (int obj = 0; obj < N_OBJECTIVES && distance != INFINITY; ++obj) {
+			__local float *values = (obj == 0) ? fitness0 : fitness1;
+			float value = values[i];
+			float fMin = value;
+			float fMax = value;
+			int previous = -1;
+			int next = -1;
+			for (int j = 0; j < nIndividuals; ++j) {
+				if (rank[j] == rank[i] && j != i) {
+					fMin = min(fMin, values[j]);
+					fMax = max(fMax, values[j]);
+					if ((values[j] < value || (values[j] == value && j < i)) && (previous < 0 || values[j] > values[previous] || (values[j] == values[previous] && j > previous))) {
+						previous = j;
+					}
+					if ((values[j] > value || (values[j] == value && j > i)) && (next < 0 || values[j] < values[next] || (values[j] == values[next] && j < next))) {
+						next = j;
+					}
+				}
+			}
+
+			distance = (previous < 0 || next < 0 || fMax == fMin) ? INFINITY : distance + (values[next] - values[previous]) / (fMax - fMin);
+		}
+		crowding[i] = distance;
+	}
+
+	// Syncpoint
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+
+	/******************** Survivors selection *********************/
+
+	// The position of each individual is the number of individuals better than it
+	for (int i = localId; i < nIndividuals; i += localSize) {
+		int position = 0;
+		for (int j = 0; j < nIndividuals; ++j) {
+			if (rank[j] < rank[i] || (rank[j] == rank[i] && (crowding[j] > crowding[i] || (crowding[j] == crowding[i] && j < i)))) {
+				++position;
+			}
+		}
+
+		if (position < SUBPOP_SIZE) {
+			survivors[position] = subpop[i];
+			survivors[position].rank = rank[i];
+			survivors[position].crowding = crowding[i];
+		}
+	}
+
+	if (localId == 0) {
+		int nFront0 = 0;
+		for (int i = 0; i < nIndividuals; ++i) {
+			nFront0 += (rank[i] == 0);
+		}
+		*nIndsFront0 = nFront0;
+	}
+
+	// Syncpoint
+	barrier(CLK_GLOBAL_MEM_FENCE);
+
+	for (int i = localId; i < SUBPOP_SIZE; i += localSize) {
+		subpop[i] = survivors[i];
+	}
+}
@@ -9,14 +9,29 @@
 
 #include "evaluation.h"
 #include "zitzler.h"
+#include <algorithm> // std::stable_sort, std::any_of
+#include <climits> // INT_MAX
+#include <immintrin.h> // AVX2 and VNNI intrinsics
 #include <omp.h> // OpenMP
 #include <math.h> // exp, sqrt, INFINITY
+#include <numeric> // std::iota
+#include <string.h> // memcpy
+#include <sys/mman.h> // madvise
+#include <unistd.h> // sysconf
+
+/********************************* Defines ********************************/
+
+/**
+ * @brief Function which computes the squared distance between a quantized instance and a quantized centroid over the selected features
+ */
+typedef int (*QuantizedDistanceFunction)(const unsigned char *const, const unsigned char *const, const unsigned char *const, const int);
 
 /********************************* Methods ********************************/
 
 
 /**
  * @brief Evaluation of each individual in CPU in Sequential mode or using OpenMP
+ * @tparam FIXED_FEATURES The number of features known at compile time, so the loops over the features have a constant trip count, or 0 if it is only known at runtime
  * @param subpop The first individual to evaluate of the current subpopulation
  * @param nIndividuals The number of individuals which will be evaluated
  * @param trDataBase The training database which will contain the instances and the features
@@ -24,29 +39,32 @@
  * @param nThreads The number of threads to perform the individuals evaluation
  * @param conf The structure with all configuration parameters
  */
-void evaluationCPU(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+template <int FIXED_FEATURES>
+void evaluationCPUFeatures(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+
+	const int nFeatures = (FIXED_FEATURES > 0) ? FIXED_FEATURES : conf -> nFeatures;
 
 
 	/************ K-means algorithm in C++ ***********/
 
 	#pragma omp parallel num_threads(nThreads) if (nThreads > 1)
 	{
-		const int totalCoord = conf -> K * conf -> nFeatures;
+		const int totalCoord = conf -> K * nFeatures;
 		unsigned char mapping[conf -> trNInstances];
 		float centroids[totalCoord];
 		float distCentroids[conf -> trNInstances];
 		int samples_in_k[conf -> K];
 
-		// Evaluate all individuals
-		#pragma omp for
+		// Evaluate all individuals. The cost of each individual is different, so they are dynamically distributed
+		#pragma omp for schedule(dynamic, 1)
 		for (int ind = 0; ind < nIndividuals; ++ind) {
 
 			// The centroids will have the selected features of the individual
 			for (int k = 0; k < conf -> K; ++k) {
-				int posTrDataBase = selInstances[k] * conf -> nFeatures;
-				int posCentr = k * conf -> nFeatures;
+				int posTrDataBase = selInstances[k] * nFeatures;
+				int posCentr = k * nFeatures;
 
-				for (int f = 0; f < conf -> nFeatures; ++f) {
+				for (int f = 0; f < nFeatures; ++f) {
 					centroids[posCentr + f] = trDataBase[posTrDataBase + f];
 				}
 			}
@@ -70,10 +88,10 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
 				for (int i = 0; i < conf -> trNInstances; ++i) {
 					float minDist = INFINITY;
 					int selectCentroid;
-					int pos = conf -> nFeatures * i;
-					for (int k = 0, posCentr = 0; k < conf -> K; ++k, posCentr += conf -> nFeatures) {
+					int pos = nFeatures * i;
+					for (int k = 0, posCentr = 0; k < conf -> K; ++k, posCentr += nFeatures) {
 						float dist = 0.0f;
-						for (int f = 0; f < conf -> nFeatures; ++f) {
+						for (int f = 0; f < nFeatures; ++f) {
 							if (subpop[ind].chromosome[f]) {
 								float dif = trDataBase[pos + f] - centroids[posCentr + f];
 								dist += dif * dif;
@@ -94,16 +112,16 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
 				}
 
 				// Update the position of the centroids
-				for (int f = 0; f < conf -> nFeatures; ++f) {
+				for (int f = 0; f < nFeatures; ++f) {
 					if (subpop[ind].chromosome[f]) {
 						for (int k = 0; k < conf -> K; ++k) {
 							float sum = 0.0f;
 							for (int i = 0; i < conf -> trNInstances; ++i) {
 								if (mapping[i] == k) {
-									sum += trDataBase[(conf -> nFeatures * i) + f];
+									sum += trDataBase[(nFeatures * i) + f];
 								}
 							}
-							centroids[(k * conf -> nFeatures) + f] = (samples_in_k[k] > 0) ? sum / samples_in_k[k] : centroids[(k * conf -> nFeatures) + f];
+							centroids[(k * nFeatures) + f] = (samples_in_k[k] > 0) ? sum / samples_in_k[k] : centroids[(k * nFeatures) + f];
 						}
 					}
 				}
@@ -121,10 +139,10 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
 			}
 
 			// Inter-cluster
-			for (int posCentr = 0; posCentr < totalCoord; posCentr += conf -> nFeatures) {
-				for (int i = posCentr + conf -> nFeatures; i < totalCoord; i += conf -> nFeatures) {
+			for (int posCentr = 0; posCentr < totalCoord; posCentr += nFeatures) {
+				for (int i = posCentr + nFeatures; i < totalCoord; i += nFeatures) {
 					float sum = 0.0f;
-					for (int f = 0; f < conf -> nFeatures; ++f) {
+					for (int f = 0; f < nFeatures; ++f) {
 						if (subpop[ind].chromosome[f]) {
 							sum += (centroids[posCentr + f] - centroids[i + f]) * (centroids[posCentr + f] - centroids[i + f]);
 						}
@@ -144,7 +162,740 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
 
 
 /**
- * @brief Evaluation of each individual on OpenCL devices
+ * @brief Evaluation of each individual in CPU in Sequential mode or using OpenMP
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationCPU(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+
+	// The most common widths have their own instantiation. The rest of widths use the generic one
+	switch (conf -> nFeatures) {
+		case 64: evaluationCPUFeatures<64>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		case 128: evaluationCPUFeatures<128>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		case 480: evaluationCPUFeatures<480>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		case 1024: evaluationCPUFeatures<1024>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		default: evaluationCPUFeatures<0>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf);
+	}
+}
+
+
+/**
+ * @brief Evaluation of each individual in CPU for the out-of-core mode. The instances are streamed in blocks from the memory-mapped database, so each block is read once per K-means iteration and used by all the individuals while it is in cache. The K-means accumulators of each individual are carried across the blocks
+ * @tparam FIXED_FEATURES The number of features known at compile time, so the loops over the features have a constant trip count, or 0 if it is only known at runtime
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+template <int FIXED_FEATURES>
+void evaluationCPUBlocksFeatures(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+
+	const int nFeatures = (FIXED_FEATURES > 0) ? FIXED_FEATURES : conf -> nFeatures;
+
+	const int totalCoord = conf -> K * nFeatures;
+	const int blockInstances = std::max((size_t) 1, EV_BLOCK_BYTES / (nFeatures * sizeof(float)));
+	const size_t pageSize = sysconf(_SC_PAGESIZE);
+
+	// The state of K-means of all individuals is kept while the blocks are streamed
+	std::vector<float> centroids((size_t) nIndividuals * totalCoord);
+	std::vector<float> sums((size_t) nIndividuals * totalCoord);
+	std::vector<int> samples_in_k((size_t) nIndividuals * conf -> K);
+	std::vector<float> sumWithin(nIndividuals, 0.0f);
+
+	#pragma omp parallel num_threads(nThreads) if (nThreads > 1)
+	{
+
+		// The centroids will have the selected features of each individual
+		#pragma omp for
+		for (int ind = 0; ind < nIndividuals; ++ind) {
+			for (int k = 0; k < conf -> K; ++k) {
+				memcpy(&centroids[((size_t) ind * totalCoord) + (k * nFeatures)], trDataBase + ((size_t) selInstances[k] * nFeatures), nFeatures * sizeof(float));
+			}
+		}
+
+
+		/******************** Convergence process *********************/
+
+		// To avoid poor performance, "conf -> maxIterKmeans" iterations are executed
+		for (int maxIter = 0; maxIter < conf -> maxIterKmeans; ++maxIter) {
+			const bool lastIter = (maxIter == conf -> maxIterKmeans - 1);
+
+			#pragma omp for
+			for (int ind = 0; ind < nIndividuals; ++ind) {
+				std::fill(sums.begin() + ((size_t) ind * totalCoord), sums.begin() + ((size_t) (ind + 1) * totalCoord), 0.0f);
+				std::fill(samples_in_k.begin() + ((size_t) ind * conf -> K), samples_in_k.begin() + ((size_t) (ind + 1) * conf -> K), 0);
+			}
+
+			for (int first = 0; first < conf -> trNInstances; first += blockInstances) {
+				const int last = std::min(first + blockInstances, conf -> trNInstances);
+
+				// The next block is requested to the operating system while the current one is processed
+				#pragma omp single nowait
+				if (last < conf -> trNInstances) {
+					const char *next = (const char *) (trDataBase + ((size_t) last * nFeatures));
+					const char *page = (const char *) (((uintptr_t) next / pageSize) * pageSize);
+					madvise((void *) page, (next - page) + (std::min(blockInstances, conf -> trNInstances - last) * nFeatures * sizeof(float)), MADV_WILLNEED);
+				}
+
+				// The cost of each individual is different, so they are dynamically distributed
+				#pragma omp for schedule(dynamic, 1)
+				for (int ind = 0; ind < nIndividuals; ++ind) {
+					const unsigned char *const chromosome = subpop[ind].chromosome.data();
+					const float *const indCentroids = &centroids[(size_t) ind * totalCoord];
+					float *const indSums = &sums[(size_t) ind * totalCoord];
+					int *const indSamples = &samples_in_k[(size_t) ind * conf -> K];
+
+					// Calculate the distances (Euclidean distance) between each instance of the block and the centroids
+					for (int i = first; i < last; ++i) {
+						const float *const instance = trDataBase + ((size_t) nFeatures * i);
+						float minDist = INFINITY;
+						int selectCentroid = 0;
+						for (int k = 0, posCentr = 0; k < conf -> K; ++k, posCentr += nFeatures) {
+							float dist = 0.0f;
+							for (int f = 0; f < nFeatures; ++f) {
+								if (chromosome[f]) {
+									float dif = instance[f] - indCentroids[posCentr + f];
+									dist += dif * dif;
+								}
+							}
+
+							if (dist < minDist) {
+								minDist = dist;
+								selectCentroid = k;
+							}
+						}
+
+						// The instance is accumulated in its centroid. The within-cluster distances are only needed in the last iteration
+						++indSamples[selectCentroid];
+						float *const centroidSums = indSums + (selectCentroid * nFeatures);
+						for (int f = 0; f < nFeatures; ++f) {
+							if (chromosome[f]) {
+								centroidSums[f] += instance[f];
+							}
+						}
+						if (lastIter) {
+							sumWithin[ind] += sqrt(minDist);
+						}
+					}
+				}
+			}
+
+			// Update the position of the centroids
+			#pragma omp for
+			for (int ind = 0; ind < nIndividuals; ++ind) {
+				for (int k = 0; k < conf -> K; ++k) {
+					int samples = samples_in_k[((size_t) ind * conf -> K) + k];
+					for (int f = 0; f < nFeatures; ++f) {
+						size_t pos = ((size_t) ind * totalCoord) + (k * nFeatures) + f;
+						if (subpop[ind].chromosome[f] && samples > 0) {
+							centroids[pos] = sums[pos] / samples;
+						}
+					}
+				}
+			}
+		}
+
+
+		/************ Minimize the within-cluster and maximize Inter-cluster sum of squares (WCSS and ICSS) *************/
+
+		#pragma omp for
+		for (int ind = 0; ind < nIndividuals; ++ind) {
+			const float *const indCentroids = &centroids[(size_t) ind * totalCoord];
+			float sumInter = 0.0f;
+
+			// Inter-cluster
+			for (int posCentr = 0; posCentr < totalCoord; posCentr += nFeatures) {
+				for (int i = posCentr + nFeatures; i < totalCoord; i += nFeatures) {
+					float sum = 0.0f;
+					for (int f = 0; f < nFeatures; ++f) {
+						if (subpop[ind].chromosome[f]) {
+							sum += (indCentroids[posCentr + f] - indCentroids[i + f]) * (indCentroids[posCentr + f] - indCentroids[i + f]);
+						}
+					}
+					sumInter += sqrt(sum);
+				}
+			}
+
+			// First objective function (Within-cluster sum of squares (WCSS))
+			subpop[ind].fitness[0] = sumWithin[ind];
+
+			// Second objective function (Inter-cluster sum of squares (ICSS))
+			subpop[ind].fitness[1] = sumInter;
+		}
+	}
+}
+
+
+/**
+ * @brief Evaluation of each individual in CPU for the out-of-core mode. The instances are streamed in blocks from the memory-mapped database, so each block is read once per K-means iteration and used by all the individuals while it is in cache. The K-means accumulators of each individual are carried across the blocks
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationCPUBlocks(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+
+	// The most common widths have their own instantiation. The rest of widths use the generic one
+	switch (conf -> nFeatures) {
+		case 64: evaluationCPUBlocksFeatures<64>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		case 128: evaluationCPUBlocksFeatures<128>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		case 480: evaluationCPUBlocksFeatures<480>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		case 1024: evaluationCPUBlocksFeatures<1024>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf); break;
+		default: evaluationCPUBlocksFeatures<0>(subpop, nIndividuals, trDataBase, selInstances, nThreads, conf);
+	}
+}
+
+
+/**
+ * @brief Squared Euclidean distance between a quantized instance and a quantized centroid over the selected features
+ * @param instance The quantized instance
+ * @param centroid The quantized centroid
+ * @param mask The selected features (0xFF) and the rest of values (0)
+ * @param stride The number of values of the instance, which is a multiple of "BD_QUANTIZED_ALIGNMENT"
+ * @return The squared distance in quantized units
+ */
+int quantizedDistance(const unsigned char *const instance, const unsigned char *const centroid, const unsigned char *const mask, const int stride) {
+
+	int dist = 0;
+	for (int f = 0; f < stride; ++f) {
+		int dif = (mask[f]) ? instance[f] - centroid[f] : 0;
+		dist += dif * dif;
+	}
+
+	return dist;
+}
+
+
+/**
+ * @brief Adds the 32-bit integers of a vector
+ * @param v The vector
+ * @return The sum of its integers
+ */
+__attribute__((target("avx2"))) inline int horizontalSum(const __m256i v) {
+
+	__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+
+/**
+ * @brief Squared Euclidean distance between a quantized instance and a quantized centroid over the selected features, using the AVX2 8-bit multiply-add instructions
+ *
+ * The absolute differences fit in 7 bits, so each one is multiplied by itself (masked by the selected features) as an unsigned and a signed byte
+ * @param instance The quantized instance
+ * @param centroid The quantized centroid
+ * @param mask The selected features (0xFF) and the rest of values (0)
+ * @param stride The number of values of the instance, which is a multiple of "BD_QUANTIZED_ALIGNMENT"
+ * @return The squared distance in quantized units
+ */
+__attribute__((target("avx2"))) int quantizedDistanceAVX2(const unsigned char *const instance, const unsigned char *const centroid, const unsigned char *const mask, const int stride) {
+
+	const __m256i ones = _mm256_set1_epi16(1);
+	__m256i dist = _mm256_setzero_si256();
+	for (int f = 0; f < stride; f += BD_QUANTIZED_ALIGNMENT) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (instance + f));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (centroid + f));
+		__m256i dif = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+		__m256i selected = _mm256_and_si256(dif, _mm256_loadu_si256((const __m256i *) (mask + f)));
+		dist = _mm256_add_epi32(dist, _mm256_madd_epi16(_mm256_maddubs_epi16(dif, selected), ones));
+	}
+
+	return horizontalSum(dist);
+}
+
+
+/**
+ * @brief Squared Euclidean distance between a quantized instance and a quantized centroid over the selected features, using the AVX-VNNI 8-bit dot products
+ * @param instance The quantized instance
+ * @param centroid The quantized centroid
+ * @param mask The selected features (0xFF) and the rest of values (0)
+ * @param stride The number of values of the instance, which is a multiple of "BD_QUANTIZED_ALIGNMENT"
+ * @return The squared distance in quantized units
+ */
+__attribute__((target("avx2,avxvnni"))) int quantizedDistanceAVXVNNI(const unsigned char *const instance, const unsigned char *const centroid, const unsigned char *const mask, const int stride) {
+
+	__m256i dist = _mm256_setzero_si256();
+	for (int f = 0; f < stride; f += BD_QUANTIZED_ALIGNMENT) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (instance + f));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (centroid + f));
+		__m256i dif = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+		__m256i selected = _mm256_and_si256(dif, _mm256_loadu_si256((const __m256i *) (mask + f)));
+		dist = _mm256_dpbusd_avx_epi32(dist, dif, selected);
+	}
+
+	return horizontalSum(dist);
+}
+
+
+/**
+ * @brief Squared Euclidean distance between a quantized instance and a quantized centroid over the selected features, using the AVX-512 VNNI 8-bit dot products on 256-bit vectors
+ * @param instance The quantized instance
+ * @param centroid The quantized centroid
+ * @param mask The selected features (0xFF) and the rest of values (0)
+ * @param stride The number of values of the instance, which is a multiple of "BD_QUANTIZED_ALIGNMENT"
+ * @return The squared distance in quantized units
+ */
+__attribute__((target("avx2,avx512vl,avx512vnni"))) int quantizedDistanceAVX512VNNI(const unsigned char *const instance, const unsigned char *const centroid, const unsigned char *const mask, const int stride) {
+
+	__m256i dist = _mm256_setzero_si256();
+	for (int f = 0; f < stride; f += BD_QUANTIZED_ALIGNMENT) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (instance + f));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (centroid + f));
+		__m256i dif = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+		__m256i selected = _mm256_and_si256(dif, _mm256_loadu_si256((const __m256i *) (mask + f)));
+		dist = _mm256_dpbusd_epi32(dist, dif, selected);
+	}
+
+	return horizontalSum(dist);
+}
+
+
+/**
+ * @brief Gets the fastest implementation of "quantizedDistance" supported by the processor
+ * @return The function which computes the distances
+ */
+QuantizedDistanceFunction getQuantizedDistance() {
+
+	if (__builtin_cpu_supports("avxvnni")) {
+		return quantizedDistanceAVXVNNI;
+	}
+	else if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl")) {
+		return quantizedDistanceAVX512VNNI;
+	}
+	else if (__builtin_cpu_supports("avx2")) {
+		return quantizedDistanceAVX2;
+	}
+	else {
+		return quantizedDistance;
+	}
+}
+
+
+/**
+ * @brief Evaluation of each individual in CPU over the training database quantized to 8 bits. The distances are computed with integer dot products, while the centroids are kept in floating point and quantized again in each iteration
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param quantizedTrDataBase The quantized training database
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationCPUQuantized(Individual *const subpop, const int nIndividuals, const QuantizedDataBase *const quantizedTrDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+
+	const int stride = quantizedTrDataBase -> stride;
+	const int totalCoord = conf -> K * stride;
+	const QuantizedDistanceFunction distance = getQuantizedDistance();
+
+
+	/************ K-means algorithm in C++ ***********/
+
+	#pragma omp parallel num_threads(nThreads) if (nThreads > 1)
+	{
+		std::vector<unsigned char> mask(stride, 0);
+		std::vector<float> centroids(totalCoord);
+		std::vector<unsigned char> quantizedCentroids(totalCoord, 0);
+		std::vector<int> sums(totalCoord);
+		int samples_in_k[conf -> K];
+
+		// Evaluate all individuals. The cost of each individual is different, so they are dynamically distributed
+		#pragma omp for schedule(dynamic, 1)
+		for (int ind = 0; ind < nIndividuals; ++ind) {
+			for (int f = 0; f < conf -> nFeatures; ++f) {
+				mask[f] = (subpop[ind].chromosome[f]) ? 0xFF : 0;
+			}
+
+			// The centroids will have the selected features of the individual
+			for (int k = 0; k < conf -> K; ++k) {
+				const unsigned char *const instance = &(quantizedTrDataBase -> values[(size_t) stride * selInstances[k]]);
+				for (int f = 0; f < stride; ++f) {
+					centroids[(k * stride) + f] = instance[f];
+				}
+			}
+
+
+			/******************** Convergence process *********************/
+
+			// To avoid poor performance, "conf -> maxIterKmeans" iterations are executed
+			float sumWithin = 0.0f;
+			for (int maxIter = 0; maxIter < conf -> maxIterKmeans; ++maxIter) {
+				const bool lastIter = (maxIter == conf -> maxIterKmeans - 1);
+				for (int c = 0; c < totalCoord; ++c) {
+					quantizedCentroids[c] = (unsigned char) std::min(BD_QUANTIZED_LEVELS, std::max(0, (int) lrintf(centroids[c])));
+					sums[c] = 0;
+				}
+				for (int k = 0; k < conf -> K; ++k) {
+					samples_in_k[k] = 0;
+				}
+
+				// Calculate all distances (Euclidean distance) between each instance and the centroids
+				for (int i = 0; i < conf -> trNInstances; ++i) {
+					const unsigned char *const instance = &(quantizedTrDataBase -> values[(size_t) stride * i]);
+					int minDist = INT_MAX;
+					int selectCentroid = 0;
+					for (int k = 0; k < conf -> K; ++k) {
+						int dist = distance(instance, &quantizedCentroids[k * stride], mask.data(), stride);
+						if (dist < minDist) {
+							minDist = dist;
+							selectCentroid = k;
+						}
+					}
+
+					// The instance is accumulated in its centroid. The within-cluster distances are only needed in the last iteration
+					++samples_in_k[selectCentroid];
+					int *const centroidSums = &sums[selectCentroid * stride];
+					for (int f = 0; f < stride; ++f) {
+						centroidSums[f] += instance[f];
+					}
+					if (lastIter) {
+						sumWithin += sqrtf((float) minDist);
+					}
+				}
+
+				// Update the position of the centroids
+				for (int k = 0; k < conf -> K; ++k) {
+					if (samples_in_k[k] > 0) {
+						for (int f = 0; f < stride; ++f) {
+							centroids[(k * stride) + f] = sums[(k * stride) + f] / (float) samples_in_k[k];
+						}
+					}
+				}
+			}
+
+
+			/************ Minimize the within-cluster and maximize Inter-cluster sum of squares (WCSS and ICSS) *************/
+
+			// Inter-cluster
+			float sumInter = 0.0f;
+			for (int posCentr = 0; posCentr < totalCoord; posCentr += stride) {
+				for (int i = posCentr + stride; i < totalCoord; i += stride) {
+					float sum = 0.0f;
+					for (int f = 0; f < conf -> nFeatures; ++f) {
+						if (mask[f]) {
+							sum += (centroids[posCentr + f] - centroids[i + f]) * (centroids[posCentr + f] - centroids[i + f]);
+						}
+					}
+					sumInter += sqrtf(sum);
+				}
+			}
+
+			// The objectives are scaled back from the quantized units
+			subpop[ind].fitness[0] = sumWithin * quantizedTrDataBase -> scale;
+			subpop[ind].fitness[1] = sumInter * quantizedTrDataBase -> scale;
+		}
+	}
+}
+
+
+/**
+ * @brief Reports the error of the fitness obtained over the quantized training database. The individuals are evaluated again over the quantized database and over the original one, and the relative error of each objective is printed
+ * @param subpop The individuals, usually the final front 0
+ * @param nIndividuals The number of individuals
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void reportQuantizationError(const Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+
+	std::vector<Individual> reference(subpop, subpop + nIndividuals);
+	std::vector<Individual> quantized(subpop, subpop + nIndividuals);
+	QuantizedDataBase *quantizedTrDataBase = quantizeDataBase(trDataBase, conf);
+	evaluationCPU(reference.data(), nIndividuals, trDataBase, selInstances, conf -> ompThreads, conf);
+	evaluationCPUQuantized(quantized.data(), nIndividuals, quantizedTrDataBase, selInstances, conf -> ompThreads, conf);
+	delete quantizedTrDataBase;
+
+	for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
+		double meanError = 0.0;
+		double maxError = 0.0;
+		for (int i = 0; i < nIndividuals; ++i) {
+			double fitness = reference[i].fitness[obj];
+			double error = fabs(quantized[i].fitness[obj] - fitness) / std::max(fabs(fitness), 1e-30);
+			meanError += error;
+			maxError = std::max(maxError, error);
+		}
+		fprintf(stderr, "Quantization error of objective %d: mean %.4g%%, max %.4g%%\n", obj, 100.0 * meanError / std::max(nIndividuals, 1), 100.0 * maxError);
+	}
+}
+
+
+/**
+ * @brief Reports the error of the fitness obtained on the OpenCL devices. The individuals are evaluated again on the devices, which only stream the columns selected by them, and on the CPU, and the relative error of each objective is printed
+ * @param subpop The individuals, usually the final front 0
+ * @param nIndividuals The number of individuals
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void reportDevicesError(const Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+
+	std::vector<Individual> reference(subpop, subpop + nIndividuals);
+	std::vector<Individual> devices(subpop, subpop + nIndividuals);
+	evaluationCPU(reference.data(), nIndividuals, trDataBase, selInstances, std::max(conf -> ompThreads, 1), conf);
+	evaluationDevices(devices.data(), nIndividuals, devicesObject, nDevices, trDataBase, selInstances, conf);
+
+	for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
+		double meanError = 0.0;
+		double maxError = 0.0;
+		for (int i = 0; i < nIndividuals; ++i) {
+			double fitness = reference[i].fitness[obj];
+			double error = fabs(devices[i].fitness[obj] - fitness) / std::max(fabs(fitness), 1e-30);
+			meanError += error;
+			maxError = std::max(maxError, error);
+		}
+		fprintf(stderr, "Devices error of objective %d: mean %.4g%%, max %.4g%%\n", obj, 100.0 * meanError / std::max(nIndividuals, 1), 100.0 * maxError);
+	}
+}
+
+
+/**
+ * @brief Evaluation of each individual in CPU over the sparse training database. Only the non-zero values of the selected features are visited, and the distances are obtained from the dot products with the centroids, the squared norms of the centroids and the squared norms of the instances, which are precomputed once per individual
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param sparseTrDataBase The sparse training database
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param conf The structure with all configuration parameters
+ */
+void evaluationCPUSparse(Individual *const subpop, const int nIndividuals, const SparseDataBase *const sparseTrDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+
+	const size_t *const featureOffsets = sparseTrDataBase -> featureOffsets.data();
+	const int *const instances = sparseTrDataBase -> instances.data();
+	const float *const values = sparseTrDataBase -> values.data();
+	const int K = conf -> K;
+
+
+	/************ K-means algorithm in C++ ***********/
+
+	#pragma omp parallel num_threads(nThreads) if (nThreads > 1)
+	{
+		std::vector<int> selFeatures;
+		std::vector<double> instanceNorms(conf -> trNInstances);
+		std::vector<double> dots((size_t) conf -> trNInstances * K);
+		std::vector<unsigned char> mapping(conf -> trNInstances);
+		std::vector<float> centroids;
+		std::vector<float> sums;
+		double centroidNorms[K];
+		int samples_in_k[K];
+
+		// Evaluate all individuals. The cost of each individual is different, so they are dynamically distributed
+		#pragma omp for schedule(dynamic, 1)
+		for (int ind = 0; ind < nIndividuals; ++ind) {
+
+			// The centroids only have the selected features. The coordinates of the "K" centroids are contiguous for each feature
+			selFeatures.clear();
+			for (int f = 0; f < conf -> nFeatures; ++f) {
+				if (subpop[ind].chromosome[f]) {
+					selFeatures.push_back(f);
+				}
+			}
+			const int nSelFeatures = selFeatures.size();
+			const int totalCoord = nSelFeatures * K;
+			centroids.assign(totalCoord, 0.0f);
+			for (int p = 0; p < nSelFeatures; ++p) {
+				const int *const first = instances + featureOffsets[selFeatures[p]];
+				const int *const last = instances + featureOffsets[selFeatures[p] + 1];
+				for (int k = 0; k < K; ++k) {
+					const int *const instance = std::lower_bound(first, last, selInstances[k]);
+					if (instance < last && *instance == selInstances[k]) {
+						centroids[(p * K) + k] = values[instance - instances];
+					}
+				}
+			}
+
+			// The squared norms of the instances over the selected features do not change during the convergence process
+			std::fill(instanceNorms.begin(), instanceNorms.end(), 0.0);
+			for (int p = 0; p < nSelFeatures; ++p) {
+				for (size_t v = featureOffsets[selFeatures[p]]; v < featureOffsets[selFeatures[p] + 1]; ++v) {
+					instanceNorms[instances[v]] += values[v] * values[v];
+				}
+			}
+
+
+			/******************** Convergence process *********************/
+
+			// To avoid poor performance, "conf -> maxIterKmeans" iterations are executed
+			float sumWithin = 0.0f;
+			for (int maxIter = 0; maxIter < conf -> maxIterKmeans; ++maxIter) {
+				const bool lastIter = (maxIter == conf -> maxIterKmeans - 1);
+				for (int k = 0; k < K; ++k) {
+					centroidNorms[k] = 0.0;
+					samples_in_k[k] = 0;
+				}
+				for (int c = 0; c < totalCoord; ++c) {
+					centroidNorms[c % K] += centroids[c] * centroids[c];
+				}
+
+				// The dot products between the instances and the centroids are accumulated feature by feature
+				std::fill(dots.begin(), dots.end(), 0.0);
+				for (int p = 0; p < nSelFeatures; ++p) {
+					const float *const coords = &centroids[p * K];
+					for (size_t v = featureOffsets[selFeatures[p]]; v < featureOffsets[selFeatures[p] + 1]; ++v) {
+						double *const instanceDots = &dots[(size_t) instances[v] * K];
+						for (int k = 0; k < K; ++k) {
+							instanceDots[k] += values[v] * coords[k];
+						}
+					}
+				}
+
+				// Calculate all distances (Euclidean distance) between each instance and the centroids: |x - c|^2 = |x|^2 + |c|^2 - 2 x.c
+				for (int i = 0; i < conf -> trNInstances; ++i) {
+					float minDist = INFINITY;
+					int selectCentroid = 0;
+					for (int k = 0; k < K; ++k) {
+
+						// The rounding errors could make the distance slightly negative
+						float dist = (float) std::max(0.0, instanceNorms[i] + centroidNorms[k] - (2.0 * dots[((size_t) i * K) + k]));
+						if (dist < minDist) {
+							minDist = dist;
+							selectCentroid = k;
+						}
+					}
+
+					// The within-cluster distances are only needed in the last iteration
+					++samples_in_k[selectCentroid];
+					mapping[i] = selectCentroid;
+					if (lastIter) {
+						sumWithin += sqrtf(minDist);
+					}
+				}
+
+				// Update the position of the centroids
+				sums.assign(totalCoord, 0.0f);
+				for (int p = 0; p < nSelFeatures; ++p) {
+					float *const coordSums = &sums[p * K];
+					for (size_t v = featureOffsets[selFeatures[p]]; v < featureOffsets[selFeatures[p] + 1]; ++v) {
+						coordSums[mapping[instances[v]]] += values[v];
+					}
+				}
+				for (int c = 0; c < totalCoord; ++c) {
+					if (samples_in_k[c % K] > 0) {
+						centroids[c] = sums[c] / samples_in_k[c % K];
+					}
+				}
+			}
+
+
+			/************ Minimize the within-cluster and maximize Inter-cluster sum of squares (WCSS and ICSS) *************/
+
+			// Inter-cluster
+			float sumInter = 0.0f;
+			for (int k1 = 0; k1 < K; ++k1) {
+				for (int k2 = k1 + 1; k2 < K; ++k2) {
+					float sum = 0.0f;
+					for (int c = 0; c < totalCoord; c += K) {
+						sum += (centroids[c + k1] - centroids[c + k2]) * (centroids[c + k1] - centroids[c + k2]);
+					}
+					sumInter += sqrtf(sum);
+				}
+			}
+
+			// First objective function (Within-cluster sum of squares (WCSS))
+			subpop[ind].fitness[0] = sumWithin;
+
+			// Second objective function (Inter-cluster sum of squares (ICSS))
+			subpop[ind].fitness[1] = sumInter;
+		}
+	}
+}
+
+
+/**
+ * @brief Estimates the cost of evaluating an individual
+ * @param ind The individual
+ * @param conf The structure with all configuration parameters
+ * @return The approximate number of operations of K-means for the individual
+ */
+long int estimateCost(const Individual *const ind, const Config *const conf) {
+
+	// In each iteration, the distances to all centroids are computed for every instance over the selected features
+	return (long int) conf -> maxIterKmeans * conf -> trNInstances * conf -> K * (ind -> nSelFeatures + 1);
+}
+
+
+/**
+ * @brief Reorders the individuals in place. They are swapped, so their chromosomes are neither copied nor reallocated
+ * @param individuals The individuals
+ * @param order The current position of the individual which must be placed in each position
+ */
+void permuteIndividuals(Individual *const individuals, const std::vector<int> &order) {
+
+	// Each cycle of the permutation is rotated by swapping its individuals
+	std::vector<bool> done(order.size(), false);
+	for (size_t d = 0; d < order.size(); ++d) {
+		size_t current = d;
+		while (!done[current] && (size_t) order[current] != d) {
+			std::swap(individuals[current], individuals[order[current]]);
+			done[current] = true;
+			current = order[current];
+		}
+		done[current] = true;
+	}
+}
+
+
+/**
+ * @brief Sets the columns of the training database streamed by the K-means kernel of a GPU. If they are at most half of the features, they are compacted on the device from the transposed database
+ * @param device Structure containing the OpenCL variables of a GPU device
+ * @param columns The features selected by some individual of the batch, in increasing order
+ * @param conf The structure with all configuration parameters
+ * @param event Output event of the compaction
+ * @return True if the compaction has been enqueued, so the kernel must wait for "event", or false otherwise
+ */
+bool setColumns(CLDevice *const device, const std::vector<cl_int> &columns, const Config *const conf, cl_event *const event) {
+
+	// The features are written before returning, so the vector can be released
+	// The columns are only compacted when the batch uses at most half of them. Otherwise, the whole transposed database is streamed
+	int nColumns = columns.size();
+	bool compacted = (nColumns <= (conf -> nFeatures >> 1));
+	if (!compacted) {
+		nColumns = conf -> nFeatures;
+	}
+	else if (nColumns > device -> columnsCapacity) {
+		// The previous buffer is kept by OpenCL until the enqueued kernels which use it finish
+		if (device -> objColumnsTrDataBase != NULL) {
+			clReleaseMemObject(device -> objColumnsTrDataBase);
+		}
+		cl_int status;
+		device -> objColumnsTrDataBase = clCreateBuffer(device -> context, CL_MEM_READ_WRITE, conf -> trNInstances * nColumns * sizeof(cl_float), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_COLUMNS);
+		check(clSetKernelArg(device -> kernelColumns, 3, sizeof(cl_mem), &(device -> objColumnsTrDataBase)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT_COLUMNS);
+		device -> columnsCapacity = nColumns;
+	}
+	if (!compacted) {
+		std::vector<cl_int> allColumns(nColumns);
+		std::iota(allColumns.begin(), allColumns.end(), 0);
+		check(clEnqueueWriteBuffer(device -> commandQueue, device -> objColumns, CL_TRUE, 0, nColumns * sizeof(cl_int), allColumns.data(), 0, NULL, NULL) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_COLUMNS);
+	}
+	else if (nColumns > 0) {
+		check(clEnqueueWriteBuffer(device -> commandQueue, device -> objColumns, CL_TRUE, 0, nColumns * sizeof(cl_int), columns.data(), 0, NULL, NULL) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_COLUMNS);
+	}
+	check(clSetKernelArg(device -> kernel, 5, sizeof(cl_mem), (compacted) ? &(device -> objColumnsTrDataBase) : &(device -> objTransposedTrDataBase)) != CL_SUCCESS, "%s\n", EV_ERROR_KERNEL_ARGUMENT6);
+	check(clSetKernelArg(device -> kernel, 6, sizeof(int), &nColumns) != CL_SUCCESS, "%s\n", EV_ERROR_KERNEL_ARGUMENT7);
+
+	// Each column is stored contiguously, so the compacted database is fully used by the kernel
+	if (compacted && nColumns > 0) {
+		check(clSetKernelArg(device -> kernelColumns, 2, sizeof(int), &nColumns) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT_COLUMNS);
+		check(clEnqueueNDRangeKernel(device -> commandQueue, device -> kernelColumns, 1, NULL, &(device -> wiGlobal), &(device -> wiLocal), 0, NULL, event) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_COLUMNS);
+		return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Evaluation of each individual on OpenCL devices. The fitness is not normalized
  * @param subpop The first individual to evaluate of the current subpopulation
  * @param nIndividuals The number of individuals which will be evaluated
  * @param devicesObject Structure containing the OpenCL variables of a device
@@ -153,7 +904,45 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
  * @param selInstances The instances choosen as initial centroids
  * @param conf The structure with all configuration parameters
  */
-void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+void evaluationDevices(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+
+
+	/************ Longest processing time first ***********/
+
+	// The devices take the individuals in descending order of estimated cost, so the most expensive ones are not left for the end
+	// Moreover, the individuals evaluated by the same work-group have a similar cost
+	std::vector<int> order(nIndividuals);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](const int ind1, const int ind2) {
+		return estimateCost(&subpop[ind1], conf) > estimateCost(&subpop[ind2], conf);
+	});
+
+	// The individuals are evaluated in place. Only the fitness is written, so they are put back in their positions afterwards
+	Individual *const batch = subpop;
+	permuteIndividuals(batch, order);
+
+
+	/************ Columns of the training database used by the batch ***********/
+
+	// After a few generations, the individuals only select a small set of features, so the GPUs only stream their columns
+	// The GPUs receive the individuals with the layout of the kernels
+	std::vector<cl_int> columns;
+	std::vector<unsigned char> deviceBatch;
+	if (std::any_of(devicesObject, devicesObject + nDevices, [](const CLDevice &device) { return device.deviceType != CL_DEVICE_TYPE_CPU; })) {
+		deviceBatch.resize(nIndividuals * deviceIndividualSize(conf));
+		packDeviceIndividuals(batch, nIndividuals, deviceBatch.data(), conf);
+		std::vector<unsigned char> used(conf -> nFeatures, 0);
+		for (int i = 0; i < nIndividuals; ++i) {
+			for (int f = 0; f < conf -> nFeatures; ++f) {
+				used[f] |= subpop[i].chromosome[f];
+			}
+		}
+		for (int f = 0; f < conf -> nFeatures; ++f) {
+			if (used[f]) {
+				columns.push_back(f);
+			}
+		}
+	}
 
 
 	/************ K-means algorithm in OpenCL ***********/
@@ -166,11 +955,17 @@ void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *cons
 		bool finished = false;
 		int threadID = omp_get_thread_num();
 		cl_int status;
-		cl_event kernelEvent, copyEvent;
+		cl_event kernelEvent;
+		std::vector<unsigned char> deviceResults;
 
-		// Start the copy onto the devices
+		// Start the copy onto the devices and the compaction of the columns. The kernels wait for both
+		cl_event waitEvents[2];
+		int nWaitEvents = 1;
 		if (devicesObject[threadID].deviceType != CL_DEVICE_TYPE_CPU) {
-			check(clEnqueueWriteBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objSubpopulations, CL_FALSE, 0, nIndividuals * sizeof(Individual), subpop, 0, NULL, &copyEvent) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_INDIVIDUALS);
+			check(clEnqueueWriteBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objSubpopulations, CL_FALSE, 0, deviceBatch.size(), deviceBatch.data(), 0, NULL, &waitEvents[0]) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_INDIVIDUALS);
+			if (setColumns(&devicesObject[threadID], columns, conf, &waitEvents[1])) {
+				++nWaitEvents;
+			}
 		}
 
 		// Only 1 device (CPU or GPU)
@@ -201,13 +996,27 @@ void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *cons
 					check(clSetKernelArg(devicesObject[threadID].kernel, 4, sizeof(int), &end) != CL_SUCCESS, "%s\n", EV_ERROR_KERNEL_ARGUMENT5);
 
 					// Enqueue and execute the kernel
-					check((status = clEnqueueNDRangeKernel(devicesObject[threadID].commandQueue, devicesObject[threadID].kernel, 1, NULL, &(devicesObject[threadID].wiGlobal), &(devicesObject[threadID].wiLocal), 1, &copyEvent, &kernelEvent)) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_KERNEL);
+					check((status = clEnqueueNDRangeKernel(devicesObject[threadID].commandQueue, devicesObject[threadID].kernel, 1, NULL, &(devicesObject[threadID].wiGlobal), &(devicesObject[threadID].wiLocal), nWaitEvents, waitEvents, &kernelEvent)) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_KERNEL);
 
 					// Read the data from the devices
-					check((status = clEnqueueReadBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objSubpopulations, CL_TRUE, begin * sizeof(Individual), (end - begin) * sizeof(Individual), subpop + begin, 1, &kernelEvent, NULL)) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_READING);
+					size_t individualBytes = deviceIndividualSize(conf);
+					deviceResults.resize((end - begin) * individualBytes);
+					check((status = clEnqueueReadBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objSubpopulations, CL_TRUE, begin * individualBytes, deviceResults.size(), deviceResults.data(), 1, &kernelEvent, NULL)) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_READING);
+					unpackDeviceFitness(deviceResults.data(), end - begin, batch + begin, conf);
 				}
 				else {
-					evaluationCPU(subpop + begin, end - begin, trDataBase, selInstances, devicesObject[threadID].computeUnits, conf);
+					if (conf -> trOutOfCore) {
+						evaluationCPUBlocks(batch + begin, end - begin, trDataBase, selInstances, devicesObject[threadID].computeUnits, conf);
+					}
+					else if (devicesObject[threadID].sparseTrDataBase != NULL) {
+						evaluationCPUSparse(batch + begin, end - begin, devicesObject[threadID].sparseTrDataBase, selInstances, devicesObject[threadID].computeUnits, conf);
+					}
+					else if (devicesObject[threadID].quantizedTrDataBase != NULL) {
+						evaluationCPUQuantized(batch + begin, end - begin, devicesObject[threadID].quantizedTrDataBase, selInstances, devicesObject[threadID].computeUnits, conf);
+					}
+					else {
+						evaluationCPU(batch + begin, end - begin, trDataBase, selInstances, devicesObject[threadID].computeUnits, conf);
+					}
 				}
 			}
 			else {
@@ -216,46 +1025,135 @@ void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *cons
 		} while (!finished);
 	}
 
+	// Each individual is returned to its original position
+	std::vector<int> position(nIndividuals);
+	for (int i = 0; i < nIndividuals; ++i) {
+		position[order[i]] = i;
+	}
+	permuteIndividuals(batch, position);
+}
+
+
+/**
+ * @brief Evaluation of each individual on OpenCL devices
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param conf The structure with all configuration parameters
+ */
+void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+
+	evaluationDevices(subpop, nIndividuals, devicesObject, nDevices, trDataBase, selInstances, conf);
+
 	// Fitness normalization
 	normalizeFitness(subpop, nIndividuals, conf);
 }
 
 
 /**
- * @brief Normalize the fitness for each individual
- * @param subpop The first individual to normalize of the current subpopulation
- * @param nIndividuals The number of individuals which will be normalized
+ * @brief Evaluation of the individuals of several subpopulations in a single batch. The individuals are gathered, evaluated at once by all devices and scattered back to their subpopulations
+ * @param subpops The subpopulations
+ * @param nSubpopulations The number of subpopulations
+ * @param offset The position of the first individual to evaluate inside each subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated in each subpopulation
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
  * @param conf The structure with all configuration parameters
  */
-void normalizeFitness(Individual *const subpop, const int nIndividuals, const Config *const conf) {
+void evaluationIslands(Individual *const subpops, const int nSubpopulations, const int offset, const int *const nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+
+	// Gather the individuals of all subpopulations
+	int first[nSubpopulations];
+	int totalIndividuals = 0;
+	for (int sp = 0; sp < nSubpopulations; ++sp) {
+		first[sp] = totalIndividuals;
+		totalIndividuals += nIndividuals[sp];
+	}
+
+	// The individuals are swapped with the empty ones of the batch, so their chromosomes are not copied
+	Individual *batch = new Individual[totalIndividuals];
+	for (int sp = 0; sp < nSubpopulations; ++sp) {
+		Individual *subpop = subpops + (sp * conf -> familySize) + offset;
+		std::swap_ranges(subpop, subpop + nIndividuals[sp], batch + first[sp]);
+	}
+
+	// Only one launch per device for the whole batch
+	evaluationDevices(batch, totalIndividuals, devicesObject, nDevices, trDataBase, selInstances, conf);
+
+	// Scatter the individuals back. The normalization is performed inside each subpopulation
+	#pragma omp parallel for
+	for (int sp = 0; sp < nSubpopulations; ++sp) {
+		Individual *subpop = subpops + (sp * conf -> familySize) + offset;
+		std::swap_ranges(batch + first[sp], batch + first[sp] + nIndividuals[sp], subpop);
+		normalizeFitness(subpop, nIndividuals[sp], conf);
+	}
+
+	// Local resources used are released
+	delete[] batch;
+}
+
+
+/**
+ * @brief Computes the average and the standard deviation of each objective
+ * @param subpop The first individual of the current subpopulation
+ * @param nIndividuals The number of individuals
+ * @param average Output average of each objective
+ * @param deviation Output standard deviation of each objective
+ * @param conf The structure with all configuration parameters
+ */
+void getFitnessStatistics(const Individual *const subpop, const int nIndividuals, float *const average, float *const deviation, const Config *const conf) {
 
 	for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
 
 		// Fitness vector average
-		float average = 0;
+		average[obj] = 0;
 		for (int i = 0; i < nIndividuals; ++i) {
-			average += subpop[i].fitness[obj];
+			average[obj] += subpop[i].fitness[obj];
 		}
 
-		average /= nIndividuals;
+		average[obj] /= nIndividuals;
 
 		// Fitness vector variance
 		float variance = 0;
 		for (int i = 0; i < nIndividuals; ++i) {
-			variance += (subpop[i].fitness[obj] - average) * (subpop[i].fitness[obj] - average);
+			variance += (subpop[i].fitness[obj] - average[obj]) * (subpop[i].fitness[obj] - average[obj]);
 		}
 		variance /= (nIndividuals - 1);
 
 		// Fitness vector standard deviation
-		float std_deviation = sqrt(variance);
+		deviation[obj] = sqrt(variance);
+	}
+}
+
+
+/**
+ * @brief Normalize the fitness for each individual with the given statistics of each objective
+ * @param subpop The first individual to normalize of the current subpopulation
+ * @param nIndividuals The number of individuals which will be normalized
+ * @param average The average of each objective
+ * @param deviation The standard deviation of each objective
+ * @param conf The structure with all configuration parameters
+ */
+void normalizeFitness(Individual *const subpop, const int nIndividuals, const float *const average, const float *const deviation, const Config *const conf) {
+
+	for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
+
+		// If all the values are equal (or there is only one), they are placed in the middle of the range instead of dividing by zero
+		bool constant = !(deviation[obj] > 0.0f);
 
 		// The second objective is a maximization problem. x_new must be negative
 		if (obj == 1) {
 
 			// Normalize a set of continuous values using SoftMax (based on the logistic function)
 			for (int i = 0; i < nIndividuals; ++i) {
-				float x_scaled = (subpop[i].fitness[obj] - average) / std_deviation;
+				float x_scaled = (constant) ? 0.0f : (subpop[i].fitness[obj] - average[obj]) / deviation[obj];
 				float x_new = 1.0f / (1.0f + exp(-x_scaled));
+				subpop[i].rawFitness[obj] = subpop[i].fitness[obj];
 				subpop[i].fitness[obj] = -x_new;
 			}
 		}
@@ -263,7 +1161,8 @@ void normalizeFitness(Individual *const subpop, const int nIndividuals, const Co
 
 			// Normalize a set of continuous values using SoftMax (based on the logistic function)
 			for (int i = 0; i < nIndividuals; ++i) {
-				float x_scaled = (subpop[i].fitness[obj] - average) / std_deviation;
+				float x_scaled = (constant) ? 0.0f : (subpop[i].fitness[obj] - average[obj]) / deviation[obj];
+				subpop[i].rawFitness[obj] = subpop[i].fitness[obj];
 				subpop[i].fitness[obj] = 1.0f / (1.0f + exp(-x_scaled));
 			}
 		}
@@ -271,6 +1170,21 @@ void normalizeFitness(Individual *const subpop, const int nIndividuals, const Co
 }
 
 
+/**
+ * @brief Normalize the fitness for each individual with the statistics of the individuals themselves
+ * @param subpop The first individual to normalize of the current subpopulation
+ * @param nIndividuals The number of individuals which will be normalized
+ * @param conf The structure with all configuration parameters
+ */
+void normalizeFitness(Individual *const subpop, const int nIndividuals, const Config *const conf) {
+
+	float average[conf -> nObjectives];
+	float deviation[conf -> nObjectives];
+	getFitnessStatistics(subpop, nIndividuals, average, deviation, conf);
+	normalizeFitness(subpop, nIndividuals, average, deviation, conf);
+}
+
+
 /**
  * @brief Gets the hypervolume measure of the subpopulation
  * @param subpop Current subpopulation
@@ -315,7 +1229,7 @@ int* getCentroids(const Config *const conf) {
 
 		// Avoid repeat centroids
 		do {
-			randomInstance = rand() % conf -> trNInstances;
+			randomInstance = random() % conf -> trNInstances;
 			exists = false;
 
 			// Look if the generated index already exists
@@ -10,6 +10,9 @@
 #include "individual.h"
 #include <algorithm> // sort...
 #include <math.h> // INFINITY...
+#include <numeric> // std::iota
+#include <stdint.h> // uint16_t, uint32_t
+#include <string.h> // memcpy, memset
 #include <vector> // std::vector...
 
 /********************************* Methods ********************************/
@@ -121,3 +124,617 @@ int nonDominationSort(Individual *const subpop, const int nIndividuals, const Co
 
 	return front[0].size();
 }
+
+
+/**
+ * @brief Compare two entries of a front by the first objective
+ * @param slot1 The first entry
+ * @param slot2 The second entry
+ * @return true if the first objective of the first individual is lower than the first objective of the second individual
+ */
+bool slotObjective0Compare(const FrontSlot &slot1, const FrontSlot &slot2) {
+
+	return slot1.ind -> fitness[0] < slot2.ind -> fitness[0];
+}
+
+
+/**
+ * @brief Check if an individual is dominated by some individual of a front sorted by the first objective
+ * @param front The front
+ * @param ind The individual to be checked
+ * @return True if the individual is dominated or false otherwise
+ */
+bool isDominatedByFront(const std::vector<FrontSlot> &front, const Individual &ind) {
+
+	// The last individual with a lower or equal first objective has the lowest second objective of them
+	FrontSlot key = {&ind, 0.0f};
+	auto it = std::upper_bound(front.begin(), front.end(), key, slotObjective0Compare);
+	if (it == front.begin()) {
+		return false;
+	}
+	--it;
+	return it -> ind -> fitness[1] <= ind.fitness[1] && !(it -> ind -> fitness[0] == ind.fitness[0] && it -> ind -> fitness[1] == ind.fitness[1]);
+}
+
+
+/**
+ * @brief Compute the crowding distance of each individual in a front sorted by the first objective
+ * @param front The front
+ */
+void updateCrowding(std::vector<FrontSlot> &front) {
+
+	int sizeFront = (int) front.size();
+	front[0].crowding = INFINITY;
+	front[sizeFront - 1].crowding = INFINITY;
+
+	// The second objective decreases along the front, so both objectives share the extreme individuals
+	float range0 = front[sizeFront - 1].ind -> fitness[0] - front[0].ind -> fitness[0];
+	float range1 = front[0].ind -> fitness[1] - front[sizeFront - 1].ind -> fitness[1];
+	for (int j = 1; j < sizeFront - 1; ++j) {
+		if (range0 == 0.0f || range1 == 0.0f) {
+			front[j].crowding = INFINITY;
+		}
+		else {
+			front[j].crowding = (front[j + 1].ind -> fitness[0] - front[j - 1].ind -> fitness[0]) / range0;
+			front[j].crowding += (front[j - 1].ind -> fitness[1] - front[j + 1].ind -> fitness[1]) / range1;
+		}
+	}
+}
+
+
+/**
+ * @brief Gets the references to the individuals of a subpopulation
+ * @param subpop The subpopulation
+ * @param nIndividuals The number of individuals of the subpopulation
+ * @return The references to the individuals
+ */
+std::vector<const Individual*> getReferences(const Individual *const subpop, const int nIndividuals) {
+
+	std::vector<const Individual*> references(nIndividuals);
+	for (int i = 0; i < nIndividuals; ++i) {
+		references[i] = subpop + i;
+	}
+
+	return references;
+}
+
+
+/**
+ * @brief The constructor with parameters. The fronts are built in O(N log N)
+ * @param subpop Current subpopulation
+ * @param nIndividuals The number of individuals of the subpopulation
+ * @return An object containing the Pareto fronts of the subpopulation
+ */
+NonDominationFronts::NonDominationFronts(const Individual *const subpop, const int nIndividuals) : NonDominationFronts(getReferences(subpop, nIndividuals)) {
+}
+
+
+/**
+ * @brief The constructor with parameters. The fronts are built in O(N log N) over individuals which are not contiguous in memory
+ * @param individuals The individuals
+ * @return An object containing the Pareto fronts of the individuals
+ */
+NonDominationFronts::NonDominationFronts(std::vector<const Individual*> individuals) {
+
+	// Sort the individuals by the first objective and, in case of tie, by the second objective
+	std::sort(individuals.begin(), individuals.end(), [](const Individual *ind1, const Individual *ind2) {
+		return (ind1 -> fitness[0] == ind2 -> fitness[0]) ? ind1 -> fitness[1] < ind2 -> fitness[1] : ind1 -> fitness[0] < ind2 -> fitness[0];
+	});
+
+	// Each individual goes to the first front whose last individual does not dominate it
+	for (size_t i = 0; i < individuals.size(); ++i) {
+		const Individual *ind = individuals[i];
+		int low = 0;
+		int high = (int) this -> fronts.size();
+		while (low < high) {
+			int mid = (low + high) >> 1;
+			const Individual *last = this -> fronts[mid].back().ind;
+			if (last -> fitness[1] <= ind -> fitness[1] && !(last -> fitness[0] == ind -> fitness[0] && last -> fitness[1] == ind -> fitness[1])) {
+				low = mid + 1;
+			}
+			else {
+				high = mid;
+			}
+		}
+
+		if (low == (int) this -> fronts.size()) {
+			this -> fronts.push_back(std::vector<FrontSlot>());
+			this -> dirty.push_back(true);
+		}
+		FrontSlot slot = {ind, 0.0f};
+		this -> fronts[low].push_back(slot);
+	}
+}
+
+
+/**
+ * @brief Insert an individual. The individuals dominated by it are moved to the next fronts
+ * @param ind The individual to be inserted. It is referenced, so it must remain unchanged until the fronts are stored
+ */
+void NonDominationFronts::insert(const Individual &ind) {
+
+	// Find the first front which does not dominate the individual
+	int low = 0;
+	int high = (int) this -> fronts.size();
+	while (low < high) {
+		int mid = (low + high) >> 1;
+		if (isDominatedByFront(this -> fronts[mid], ind)) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+
+	// The individuals dominated by the inserted ones are moved to the next front, and so on
+	FrontSlot slot = {&ind, 0.0f};
+	std::vector<FrontSlot> toInsert(1, slot);
+	for (int f = low; !toInsert.empty(); ++f) {
+		if (f == (int) this -> fronts.size()) {
+			this -> fronts.push_back(std::vector<FrontSlot>());
+			this -> dirty.push_back(true);
+		}
+
+		std::vector<FrontSlot> &front = this -> fronts[f];
+		std::vector<FrontSlot> dominated;
+		for (size_t i = 0; i < toInsert.size(); ++i) {
+
+			// The dominated individuals are contiguous: they have a higher first objective and a higher second objective
+			const Individual *current = toInsert[i].ind;
+			auto first = std::lower_bound(front.begin(), front.end(), toInsert[i], slotObjective0Compare);
+			while (first != front.end() && first -> ind -> fitness[0] == current -> fitness[0] && first -> ind -> fitness[1] == current -> fitness[1]) {
+				++first;
+			}
+			auto last = first;
+			while (last != front.end() && last -> ind -> fitness[1] >= current -> fitness[1]) {
+				++last;
+			}
+			dominated.insert(dominated.end(), first, last);
+			first = front.erase(first, last);
+			front.insert(first, toInsert[i]);
+		}
+
+		this -> dirty[f] = true;
+		toInsert.swap(dominated);
+	}
+}
+
+
+/**
+ * @brief Remove the worst individual, that is, the individual with the lowest crowding distance of the last front
+ * @return The reference to the removed individual
+ */
+const Individual* NonDominationFronts::removeWorst() {
+
+	std::vector<FrontSlot> &last = this -> fronts.back();
+	if (this -> dirty.back()) {
+		updateCrowding(last);
+	}
+
+	auto worst = std::min_element(last.begin(), last.end(), [](const FrontSlot &slot1, const FrontSlot &slot2) {
+		return slot1.crowding < slot2.crowding;
+	});
+	const Individual *removed = worst -> ind;
+	last.erase(worst);
+	this -> dirty.back() = true;
+
+	if (last.empty()) {
+		this -> fronts.pop_back();
+		this -> dirty.pop_back();
+	}
+
+	return removed;
+}
+
+
+/**
+ * @brief Redirect the reference to an individual which has been moved to another place
+ * @param ind The current reference to the individual
+ * @param place The new place of the individual
+ */
+void NonDominationFronts::relocate(const Individual *const ind, const Individual *const place) {
+
+	for (size_t f = 0; f < this -> fronts.size(); ++f) {
+		for (size_t i = 0; i < this -> fronts[f].size(); ++i) {
+			if (this -> fronts[f][i].ind == ind) {
+				this -> fronts[f][i].ind = place;
+				return;
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Get the slots of the best individuals sorted by rank and crowding distance
+ * @param nIndividuals The maximum number of slots
+ * @param ranks The place where the rank of each slot will be stored
+ * @return The sorted slots
+ */
+std::vector<FrontSlot*> NonDominationFronts::sortedSlots(const int nIndividuals, std::vector<int> *const ranks) {
+
+	// Inside each front, the slots are sorted by crowding distance
+	std::vector<FrontSlot*> sorted;
+	ranks -> clear();
+	for (size_t f = 0; f < this -> fronts.size() && (int) sorted.size() < nIndividuals; ++f) {
+		std::vector<FrontSlot> &front = this -> fronts[f];
+		if (this -> dirty[f]) {
+			updateCrowding(front);
+			this -> dirty[f] = false;
+		}
+
+		size_t first = sorted.size();
+		for (size_t i = 0; i < front.size(); ++i) {
+			sorted.push_back(&front[i]);
+		}
+		std::sort(sorted.begin() + first, sorted.end(), [](const FrontSlot *const slot1, const FrontSlot *const slot2) {
+			return slot1 -> crowding > slot2 -> crowding;
+		});
+		ranks -> resize(sorted.size(), f);
+	}
+
+	return sorted;
+}
+
+
+/**
+ * @brief Get the references to the individuals sorted by rank and crowding distance, without moving them
+ * @return The sorted references
+ */
+std::vector<const Individual*> NonDominationFronts::sortedReferences() {
+
+	std::vector<int> ranks;
+	std::vector<FrontSlot*> sorted = sortedSlots(INT_MAX, &ranks);
+	std::vector<const Individual*> references(sorted.size());
+	for (size_t i = 0; i < sorted.size(); ++i) {
+		references[i] = sorted[i] -> ind;
+	}
+
+	return references;
+}
+
+
+/**
+ * @brief Store the best individuals sorted by rank and crowding distance. The referenced individuals which are already in the destination are swapped into their new positions and only the rest are copied
+ * @param subpop The place where the individuals will be stored. It can overlap the referenced individuals
+ * @param nIndividuals The maximum number of individuals to be stored. If some individuals are not stored, the fronts must not be used afterwards
+ * @return The number of individuals in the front 0
+ */
+int NonDominationFronts::store(Individual *const subpop, const int nIndividuals) {
+
+	std::vector<int> ranks;
+	std::vector<FrontSlot*> sorted = sortedSlots(nIndividuals, &ranks);
+	const int nStored = std::min(nIndividuals, (int) sorted.size());
+
+	// Slot table: the position of the destination where each stored individual already is, or -1 if it is elsewhere
+	std::vector<int> from(nStored, -1);
+	std::vector<bool> referenced(nStored, false);
+	for (int d = 0; d < nStored; ++d) {
+		if (sorted[d] -> ind >= subpop && sorted[d] -> ind < subpop + nStored) {
+			from[d] = sorted[d] -> ind - subpop;
+			referenced[from[d]] = true;
+		}
+	}
+
+	// The positions whose individual is not kept start a chain of swaps, which ends in the position that receives an individual from elsewhere
+	// The rest of positions form cycles of swaps. The individuals are swapped, so no chromosome is copied or reallocated
+	std::vector<bool> done(nStored, false);
+	for (int pass = 0; pass < 2; ++pass) {
+		for (int d = 0; d < nStored; ++d) {
+			if (!done[d] && (pass == 1 || !referenced[d])) {
+				int current = d;
+				done[current] = true;
+				while (from[current] != -1 && from[current] != d) {
+					std::swap(subpop[current], subpop[from[current]]);
+					current = from[current];
+					done[current] = true;
+				}
+				if (from[current] == -1) {
+					subpop[current] = *(sorted[current] -> ind);
+				}
+			}
+		}
+	}
+
+	for (int d = 0; d < nStored; ++d) {
+		subpop[d].rank = ranks[d];
+		subpop[d].crowding = sorted[d] -> crowding;
+		sorted[d] -> ind = subpop + d;
+	}
+
+	return (this -> fronts.empty()) ? 0 : (int) this -> fronts[0].size();
+}
+
+
+/**
+ * @brief Gets the maximum size of the buffer which contains the packed individuals of several subpopulations
+ * @param nIndividuals The total number of individuals
+ * @param conf The structure with all configuration parameters
+ * @return The size in bytes
+ */
+size_t packedSize(const int nIndividuals, const Config *const conf) {
+
+	// The list of selected features is only used when it is smaller than the bitset
+	size_t bitsetBytes = (conf -> nFeatures + 7) >> 3;
+	size_t individualBytes = (2 * conf -> nObjectives + 1) * sizeof(float) + 2 * sizeof(int) + bitsetBytes;
+	return 2 * sizeof(int) + nIndividuals * individualBytes;
+}
+
+
+/**
+ * @brief Pack the first individuals of several subpopulations to be sent through the network. The chromosome of each individual is stored as a bitset or as a list with the indexes of the selected features, whichever is smaller
+ * @param subpops The subpopulations. Each one contains "conf -> familySize" individuals
+ * @param nSubpopulations The number of subpopulations
+ * @param nIndividuals The number of individuals packed from each subpopulation
+ * @param buffer The buffer where the individuals are packed. It must contain at least "packedSize(nSubpopulations * nIndividuals, conf)" bytes
+ * @param conf The structure with all configuration parameters
+ * @return The number of bytes used in the buffer
+ */
+int packSubpopulations(const Individual *const subpops, const int nSubpopulations, const int nIndividuals, unsigned char *const buffer, const Config *const conf) {
+
+	const int bitsetBytes = (conf -> nFeatures + 7) >> 3;
+	const int indexBytes = (conf -> nFeatures > 65536) ? sizeof(uint32_t) : sizeof(uint16_t);
+	unsigned char *ptr = buffer;
+
+	int header[2] = {nSubpopulations, nIndividuals};
+	memcpy(ptr, header, sizeof(header));
+	ptr += sizeof(header);
+
+	for (int sp = 0; sp < nSubpopulations; ++sp) {
+		for (int i = 0; i < nIndividuals; ++i) {
+			const Individual *ind = subpops + (sp * conf -> familySize) + i;
+
+			// Fitness, raw objectives, crowding distance, rank and number of selected features
+			memcpy(ptr, ind -> fitness, conf -> nObjectives * sizeof(float));
+			ptr += conf -> nObjectives * sizeof(float);
+			memcpy(ptr, ind -> rawFitness, conf -> nObjectives * sizeof(float));
+			ptr += conf -> nObjectives * sizeof(float);
+			memcpy(ptr, &(ind -> crowding), sizeof(float));
+			ptr += sizeof(float);
+			memcpy(ptr, &(ind -> rank), sizeof(int));
+			ptr += sizeof(int);
+			memcpy(ptr, &(ind -> nSelFeatures), sizeof(int));
+			ptr += sizeof(int);
+
+			// The receiver knows the format from the number of selected features
+			if (ind -> nSelFeatures * indexBytes < bitsetBytes) {
+				for (uint32_t f = 0; f < (uint32_t) conf -> nFeatures; ++f) {
+					if (ind -> chromosome[f]) {
+						uint16_t f16 = (uint16_t) f;
+						memcpy(ptr, (indexBytes == sizeof(uint16_t)) ? (void *) &f16 : (void *) &f, indexBytes);
+						ptr += indexBytes;
+					}
+				}
+			}
+			else {
+				memset(ptr, 0, bitsetBytes);
+				for (int f = 0; f < conf -> nFeatures; ++f) {
+					ptr[f >> 3] |= ind -> chromosome[f] << (f & 7);
+				}
+				ptr += bitsetBytes;
+			}
+		}
+	}
+
+	return ptr - buffer;
+}
+
+
+/**
+ * @brief Unpack the individuals packed by "packSubpopulations"
+ * @param buffer The buffer which contains the packed individuals
+ * @param subpops The place where the subpopulations will be stored. Each one contains "conf -> familySize" individuals
+ * @param conf The structure with all configuration parameters
+ * @return The total number of unpacked individuals
+ */
+int unpackSubpopulations(const unsigned char *const buffer, Individual *const subpops, const Config *const conf) {
+
+	const int bitsetBytes = (conf -> nFeatures + 7) >> 3;
+	const int indexBytes = (conf -> nFeatures > 65536) ? sizeof(uint32_t) : sizeof(uint16_t);
+	const unsigned char *ptr = buffer;
+
+	int header[2];
+	memcpy(header, ptr, sizeof(header));
+	ptr += sizeof(header);
+
+	for (int sp = 0; sp < header[0]; ++sp) {
+		for (int i = 0; i < header[1]; ++i) {
+			Individual *ind = subpops + (sp * conf -> familySize) + i;
+
+			memcpy(ind -> fitness, ptr, conf -> nObjectives * sizeof(float));
+			ptr += conf -> nObjectives * sizeof(float);
+			memcpy(ind -> rawFitness, ptr, conf -> nObjectives * sizeof(float));
+			ptr += conf -> nObjectives * sizeof(float);
+			memcpy(&(ind -> crowding), ptr, sizeof(float));
+			ptr += sizeof(float);
+			memcpy(&(ind -> rank), ptr, sizeof(int));
+			ptr += sizeof(int);
+			memcpy(&(ind -> nSelFeatures), ptr, sizeof(int));
+			ptr += sizeof(int);
+
+			if (ind -> nSelFeatures * indexBytes < bitsetBytes) {
+				ind -> chromosome.assign(conf -> nFeatures, 0);
+				for (int j = 0; j < ind -> nSelFeatures; ++j) {
+					uint32_t f = 0;
+					uint16_t f16;
+					if (indexBytes == sizeof(uint16_t)) {
+						memcpy(&f16, ptr, indexBytes);
+						f = f16;
+					}
+					else {
+						memcpy(&f, ptr, indexBytes);
+					}
+					ind -> chromosome[f] = 1;
+					ptr += indexBytes;
+				}
+			}
+			else {
+				ind -> chromosome.resize(conf -> nFeatures);
+				for (int f = 0; f < conf -> nFeatures; ++f) {
+					ind -> chromosome[f] = (ptr[f >> 3] >> (f & 7)) & 1;
+				}
+				ptr += bitsetBytes;
+			}
+		}
+	}
+
+	return header[0] * header[1];
+}
+
+
+/**
+ * @brief Checks that a buffer contains well-formed individuals packed by "packSubpopulations" without unpacking them
+ * @param buffer The buffer which contains the packed individuals
+ * @param nBytes The size of the buffer in bytes
+ * @param nSubpopulations The number of subpopulations which must be packed in the buffer
+ * @param nIndividuals The number of individuals which must be packed from each subpopulation
+ * @param conf The structure with all configuration parameters
+ * @return True if the buffer can be safely unpacked
+ */
+bool checkPackedSubpopulations(const unsigned char *const buffer, const size_t nBytes, const int nSubpopulations, const int nIndividuals, const Config *const conf) {
+
+	const size_t bitsetBytes = (conf -> nFeatures + 7) >> 3;
+	const size_t indexBytes = (conf -> nFeatures > 65536) ? sizeof(uint32_t) : sizeof(uint16_t);
+	const size_t fixedBytes = (2 * conf -> nObjectives + 1) * sizeof(float) + 2 * sizeof(int);
+	const unsigned char *ptr = buffer;
+	const unsigned char *const end = buffer + nBytes;
+
+	int header[2];
+	if (nBytes < sizeof(header)) {
+		return false;
+	}
+	memcpy(header, ptr, sizeof(header));
+	ptr += sizeof(header);
+	if (header[0] != nSubpopulations || header[1] != nIndividuals || nIndividuals > conf -> familySize) {
+		return false;
+	}
+
+	for (int i = 0; i < nSubpopulations * nIndividuals; ++i) {
+		int nSelFeatures;
+		if ((size_t) (end - ptr) < fixedBytes) {
+			return false;
+		}
+		memcpy(&nSelFeatures, ptr + fixedBytes - sizeof(int), sizeof(int));
+		ptr += fixedBytes;
+		if (nSelFeatures < 0 || nSelFeatures > conf -> nFeatures) {
+			return false;
+		}
+
+		// The indexes of the list must refer to existing features
+		if (nSelFeatures * indexBytes < bitsetBytes) {
+			if ((size_t) (end - ptr) < nSelFeatures * indexBytes) {
+				return false;
+			}
+			for (int j = 0; j < nSelFeatures; ++j) {
+				uint32_t f = 0;
+				uint16_t f16;
+				if (indexBytes == sizeof(uint16_t)) {
+					memcpy(&f16, ptr, indexBytes);
+					f = f16;
+				}
+				else {
+					memcpy(&f, ptr, indexBytes);
+				}
+				if (f >= (uint32_t) conf -> nFeatures) {
+					return false;
+				}
+				ptr += indexBytes;
+			}
+		}
+		else {
+			if ((size_t) (end - ptr) < bitsetBytes) {
+				return false;
+			}
+			ptr += bitsetBytes;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Gets the size of an individual in the layout of the OpenCL kernels, whose chromosome has "N_FEATURES" positions
+ * @param conf The structure with all configuration parameters
+ * @return The size in bytes
+ */
+size_t deviceIndividualSize(const Config *const conf) {
+
+	// The chromosome is padded up to the alignment of the fitness
+	size_t chromosomeBytes = (conf -> nFeatures + 3) & ~3;
+	return chromosomeBytes + (2 * conf -> nObjectives + 1) * sizeof(float) + 2 * sizeof(int);
+}
+
+
+/**
+ * @brief Copies the individuals into a buffer with the layout of the OpenCL kernels, so it can be written to the devices
+ * @param individuals The individuals
+ * @param nIndividuals The number of individuals
+ * @param buffer The buffer where the individuals are copied. It must contain at least "nIndividuals * deviceIndividualSize(conf)" bytes
+ * @param conf The structure with all configuration parameters
+ */
+void packDeviceIndividuals(const Individual *const individuals, const int nIndividuals, unsigned char *const buffer, const Config *const conf) {
+
+	const size_t chromosomeBytes = (conf -> nFeatures + 3) & ~3;
+	const size_t individualBytes = deviceIndividualSize(conf);
+	memset(buffer, 0, nIndividuals * individualBytes);
+	for (int i = 0; i < nIndividuals; ++i) {
+		unsigned char *ptr = buffer + i * individualBytes;
+		memcpy(ptr, individuals[i].chromosome.data(), conf -> nFeatures);
+		ptr += chromosomeBytes;
+		memcpy(ptr, individuals[i].fitness, conf -> nObjectives * sizeof(float));
+		ptr += conf -> nObjectives * sizeof(float);
+		memcpy(ptr, individuals[i].rawFitness, conf -> nObjectives * sizeof(float));
+		ptr += conf -> nObjectives * sizeof(float);
+		memcpy(ptr, &(individuals[i].crowding), sizeof(float));
+		ptr += sizeof(float);
+		memcpy(ptr, &(individuals[i].rank), sizeof(int));
+		ptr += sizeof(int);
+		memcpy(ptr, &(individuals[i].nSelFeatures), sizeof(int));
+	}
+}
+
+
+/**
+ * @brief Copies the individuals read from the devices, which have the layout of the OpenCL kernels
+ * @param buffer The buffer which contains the individuals
+ * @param nIndividuals The number of individuals
+ * @param individuals The place where the individuals will be stored
+ * @param conf The structure with all configuration parameters
+ */
+void unpackDeviceIndividuals(const unsigned char *const buffer, const int nIndividuals, Individual *const individuals, const Config *const conf) {
+
+	const size_t chromosomeBytes = (conf -> nFeatures + 3) & ~3;
+	const size_t individualBytes = deviceIndividualSize(conf);
+	for (int i = 0; i < nIndividuals; ++i) {
+		const unsigned char *ptr = buffer + i * individualBytes;
+		individuals[i].chromosome.assign(ptr, ptr + conf -> nFeatures);
+		ptr += chromosomeBytes;
+		memcpy(individuals[i].fitness, ptr, conf -> nObjectives * sizeof(float));
+		ptr += conf -> nObjectives * sizeof(float);
+		memcpy(individuals[i].rawFitness, ptr, conf -> nObjectives * sizeof(float));
+		ptr += conf -> nObjectives * sizeof(float);
+		memcpy(&(individuals[i].crowding), ptr, sizeof(float));
+		ptr += sizeof(float);
+		memcpy(&(individuals[i].rank), ptr, sizeof(int));
+		ptr += sizeof(int);
+		memcpy(&(individuals[i].nSelFeatures), ptr, sizeof(int));
+	}
+}
+
+
+/**
+ * @brief Copies only the fitness of the individuals read from the devices, which have the layout of the OpenCL kernels
+ * @param buffer The buffer which contains the individuals
+ * @param nIndividuals The number of individuals
+ * @param individuals The individuals whose fitness will be updated
+ * @param conf The structure with all configuration parameters
+ */
+void unpackDeviceFitness(const unsigned char *const buffer, const int nIndividuals, Individual *const individuals, const Config *const conf) {
+
+	const size_t chromosomeBytes = (conf -> nFeatures + 3) & ~3;
+	const size_t individualBytes = deviceIndividualSize(conf);
+	for (int i = 0; i < nIndividuals; ++i) {
+		memcpy(individuals[i].fitness, buffer + i * individualBytes + chromosomeBytes, conf -> nObjectives * sizeof(float));
+	}
+}
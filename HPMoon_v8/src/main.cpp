@@ -11,7 +11,9 @@
 
 #include "bd.h"
 #include "ag.h"
+#include "checkpoint.h"
 #include "evaluation.h"
+#include "results.h"
 
 
 /**
@@ -24,63 +26,155 @@ int main(const int argc, const char **argv) {
 
 	/********** Initialize the MPI environment ***********/
 
-	MPI::Init_thread(MPI_THREAD_MULTIPLE);
+	int threadSupport;
+	MPI_Init_thread(NULL, NULL, MPI_THREAD_MULTIPLE, &threadSupport);
 
 
 	/********** Get the configuration data from the XML file or from the command-line ***********/
 
 	Config conf(argc, argv);
-	Individual *subpops;
+	MPITransport transport; // Subpopulations exchanged between the master and the workers
+	Individual *subpops = NULL; // Workers allocate their own subpopulations
 	int *selInstances;
-	srand((uint) time(NULL) + conf.mpiRank); // "+ rank" is necessary in MPI
+	seedRandom((uint) time(NULL) + conf.mpiRank); // "+ rank" is necessary in MPI
 
 	// Master
 	if (conf.mpiRank == 0 && conf.mpiSize > 1) {
 
+		// The master keeps its own copy of the database, so it stays out of the node communicators
+		MPI_Comm nodeComm;
+		MPI_Comm_split_type(MPI_COMM_WORLD, MPI_UNDEFINED, conf.mpiRank, MPI_INFO_NULL, &nodeComm);
+
+		// In the out-of-core mode, each process maps the database file by itself. The master only needs it if it also evolves subpopulations
+		const float *trDataBase = NULL;
+		const float *transposedTrDataBase = NULL;
+		if (conf.trOutOfCore) {
+			trDataBase = (conf.masterWorker) ? mapDataBase(&conf) : NULL;
+		}
+
+		// The database file is read and normalized only here and sent to one worker per node
+		// The master only needs the transposed database if it also evolves subpopulations
+		// In the sparse mode, each process reads the database by itself when its CPU device is created
+		else if (!conf.trSparse) {
+			MPI_Comm leadersComm;
+			MPI_Comm_split(MPI_COMM_WORLD, 0, conf.mpiRank, &leadersComm);
+			float *dataBase = new float[(size_t) conf.trNInstances * conf.nFeatures];
+			float *dataBaseTransposed = (conf.masterWorker) ? new float[(size_t) conf.trNInstances * conf.nFeatures] : NULL;
+			getDataBases(dataBase, dataBaseTransposed, &conf);
+			broadcastDataBase(dataBase, leadersComm, &conf);
+			MPI_Comm_free(&leadersComm);
+			trDataBase = dataBase;
+			transposedTrDataBase = dataBaseTransposed;
+		}
+
 		// Initialize the subpopulations and the individuals
 		// Subpopulations will have the parents and children (left half and right half respectively)
 		subpops = createSubpopulations(&conf);
 
 		// Get the initial "conf.K" centroids and share them with the workers
-		selInstances = getCentroids(&conf);
-		MPI::COMM_WORLD.Bcast(selInstances, conf.K, MPI::INT, 0);
+		selInstances = (conf.resume) ? readCheckpointCentroids(&conf) : getCentroids(&conf);
+		MPI_Bcast(selInstances, conf.K, MPI_INT, 0, MPI_COMM_WORLD);
 
 
 		/********** Genetic algorithm ***********/
 
-		agIslands(subpops, NULL, NULL, NULL, &conf);
+		// The master only needs the devices if it also evolves subpopulations
+		CLDevice *devices = NULL;
+		if (conf.masterWorker) {
+			devices = createDevices(trDataBase, selInstances, transposedTrDataBase, &conf);
+		}
+		agIslands(subpops, devices, trDataBase, NULL, selInstances, &transport, &conf);
+
+		// Exclusive variables used by the master are released. The results file must be finished before finalizing
+		waitResults();
+		delete[] devices;
+		if (conf.trOutOfCore) {
+			if (trDataBase != NULL) {
+				unmapDataBase(trDataBase, &conf);
+			}
+		}
+		else {
+			delete[] trDataBase;
+			delete[] transposedTrDataBase;
+		}
 	}
 
 	// Workers
 	else {
 
 		// Get the databases and its normalization if it is required
-		const float *const trDataBase = getDataBase(&conf);
-		const float *const transposedTrDataBase = transposeDataBase(trDataBase, &conf); // Transposed database
+		// They are loaded once per node and shared by all the workers running on it
+		MPI_Comm nodeComm;
+		MPI_Win dbWindow = MPI_WIN_NULL;
+		DataBaseStream *trStream = NULL;
+		const float *trDataBase = NULL;
+		const float *transposedTrDataBase = NULL; // Transposed database
+		MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, conf.mpiRank, MPI_INFO_NULL, &nodeComm);
+
+		// In the out-of-core mode, the mapped file is already shared through the page cache of the node
+		// The transposed database is only used by the OpenCL devices
+		if (conf.trOutOfCore) {
+			trDataBase = mapDataBase(&conf);
+		}
+
+		// In the streaming mode, there is only one process and the instances appended to the file are added to its database
+		else if (conf.trStream) {
+			trStream = openDataBaseStream(&conf);
+			trDataBase = trStream -> instances.data();
+		}
+
+		// The first worker of each node receives the database from the master
+		// In the sparse mode, each process reads the database by itself when its CPU device is created
+		else if (!conf.trSparse) {
+			MPI_Comm leadersComm = MPI_COMM_NULL;
+			if (conf.mpiSize > 1) {
+				int nodeRank;
+				MPI_Comm_rank(nodeComm, &nodeRank);
+				MPI_Comm_split(MPI_COMM_WORLD, (nodeRank == 0) ? 0 : MPI_UNDEFINED, conf.mpiRank, &leadersComm);
+			}
+			getSharedDataBases(&trDataBase, &transposedTrDataBase, &dbWindow, nodeComm, leadersComm, &conf);
+			if (leadersComm != MPI_COMM_NULL) {
+				MPI_Comm_free(&leadersComm);
+			}
+		}
 
 		// I am the master and I work alone
 		if (conf.mpiSize == 1) {
 			subpops = createSubpopulations(&conf);
-			selInstances = getCentroids(&conf);
+			selInstances = (conf.resume) ? readCheckpointCentroids(&conf) : getCentroids(&conf);
 		}
 
 		// Get the initial "conf.K" centroids from the master
 		else {
 			selInstances = new int[conf.K];
-			MPI::COMM_WORLD.Bcast(selInstances, conf.K, MPI::INT, 0);
+			MPI_Bcast(selInstances, conf.K, MPI_INT, 0, MPI_COMM_WORLD);
 		}
 
 
 		/********** Genetic algorithm ***********/
 
+		// The workers are simulated by threads of this process
+		if (conf.simWorkers > 0) {
+			agIslandsSimulated(subpops, trDataBase, transposedTrDataBase, selInstances, argc, argv, &conf);
+		}
+
 		// Sequential, only 1 device (CPU or GPU) or heterogeneous mode if more than 1 device is available
-		CLDevice *devices = createDevices(trDataBase, selInstances, transposedTrDataBase, &conf);
-		agIslands(subpops, devices, trDataBase, selInstances, &conf);
+		else {
+			CLDevice *devices = createDevices(trDataBase, selInstances, transposedTrDataBase, &conf);
+			agIslands(subpops, devices, trDataBase, trStream, selInstances, &transport, &conf);
+			delete[] devices;
+		}
 
-		// Exclusive variables used by the workers are released
-		delete[] devices;
-		delete[] trDataBase;
-		delete[] transposedTrDataBase;
+		// Exclusive variables used by the workers are released. The results file must be finished before finalizing
+		waitResults();
+		if (conf.trOutOfCore) {
+			unmapDataBase(trDataBase, &conf);
+		}
+		else if (dbWindow != MPI_WIN_NULL) {
+			MPI_Win_free(&dbWindow);
+		}
+		delete trStream;
+		MPI_Comm_free(&nodeComm);
 	}
 
 	// Variables used by both master and workers are released
@@ -88,5 +182,5 @@ int main(const int argc, const char **argv) {
 	delete[] selInstances;
 
 	// Finish the MPI environment
-	MPI::Finalize();
+	MPI_Finalize();
 }
@@ -0,0 +1,79 @@
+/**
+ * @file printResults.cpp
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief Tool which prints a binary results file written by HPMoon as text
+ *
+ * Each line contains an individual: its subpopulation (-1 for the final front 0), its rank, its crowding distance, its raw and normalized objectives and its selected features
+ */
+
+/********************************* Includes ********************************/
+
+#include "results.h"
+#include "cmdParser.h"
+#include <mpi.h>
+
+
+/**
+ * @brief Main program
+ * @param argc The number of arguments of the program
+ * @param argv Arguments of the program
+ */
+int main(const int argc, const char **argv) {
+
+
+	/********** Initialize the MPI environment. It is only used to report the errors ***********/
+
+	MPI_Init(NULL, NULL);
+
+
+	/********** Get the arguments from the command-line ***********/
+
+	CmdParser parser("Prints a binary results file written by HPMoon as text.", "./bin/hpmoon-results -i RESULTS_FILE [-world]", "Cluster HPMoon (C) 2018 v8.0");
+	parser.addExample("./bin/hpmoon-results -i \"gnuplot/results\"");
+	parser.addExample("./bin/hpmoon-results -i \"gnuplot/results\" -world");
+	parser.addArg("-h", false, "Display usage instructions."); // Display help
+	parser.addArg("-i", true, "Name of the results file."); // Results file
+	parser.addArg("-world", false, "Also print the individuals of the world, if they were written."); // World
+
+	check(!parser.parse(argv, argc), "%s\n", CFG_ERROR_PARSE_ARGUMENTS);
+	if (parser.isSet("-h")) {
+		parser.printHelp();
+		MPI_Finalize();
+		exit(0);
+	}
+	check(!parser.isSet("-i"), "%s\n", RS_ERROR_READ_ARGUMENTS);
+
+
+	/********** Print the individuals ***********/
+
+	Results results = readResults(parser.getValue<char*>("-i"));
+	const size_t nIndividuals = (size_t) results.header.nFront + results.header.nWorld;
+	const size_t nPrinted = (parser.isSet("-world")) ? nIndividuals : results.header.nFront;
+
+	fprintf(stdout, "#Subpopulation\tRank\tCrowding");
+	for (uint32_t obj = 0; obj < results.header.nObjectives; ++obj) {
+		fprintf(stdout, "\tObjective%u", obj);
+	}
+	for (uint32_t obj = 0; obj < results.header.nObjectives; ++obj) {
+		fprintf(stdout, "\tNormalizedObjective%u", obj);
+	}
+	fprintf(stdout, "\tFeatures\n");
+
+	for (size_t i = 0; i < nPrinted; ++i) {
+		fprintf(stdout, "%d\t%d\t%g", results.subpopulation[i], results.rank[i], results.crowding[i]);
+		for (uint32_t obj = 0; obj < results.header.nObjectives; ++obj) {
+			fprintf(stdout, "\t%f", results.objectives[(obj * nIndividuals) + i]);
+		}
+		for (uint32_t obj = 0; obj < results.header.nObjectives; ++obj) {
+			fprintf(stdout, "\t%f", results.normalizedObjectives[(obj * nIndividuals) + i]);
+		}
+		for (uint32_t f = results.featureOffsets[i]; f < results.featureOffsets[i + 1]; ++f) {
+			fprintf(stdout, (f == results.featureOffsets[i]) ? "\t%u" : ",%u", results.features[f]);
+		}
+		fprintf(stdout, "\n");
+	}
+
+	// Finish the MPI environment
+	MPI_Finalize();
+}
@@ -0,0 +1,159 @@
+/**
+ * @file results.cpp
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief File with the necessary implementation to write and read the binary files with the final results of the genetic algorithm
+ */
+
+/********************************* Includes *******************************/
+
+#include "results.h"
+#include <cstdio> // rename
+#include <fstream> // std::fstream
+#include <thread> // std::thread
+
+/******************************** Variables *******************************/
+
+/**
+ * @brief The background thread which writes the results file
+ */
+static std::thread writer;
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Writes a column of the results file
+ * @param fResults The results file
+ * @param column The values of the column
+ */
+template <typename T>
+void writeColumn(std::fstream &fResults, const std::vector<T> &column) {
+
+	fResults.write((const char *) column.data(), column.size() * sizeof(T));
+}
+
+
+/**
+ * @brief Reads a column of the results file
+ * @param fResults The results file
+ * @param column The place where the values will be stored
+ * @param nValues The number of values of the column
+ */
+template <typename T>
+void readColumn(std::fstream &fResults, std::vector<T> &column, const size_t nValues) {
+
+	column.resize(nValues);
+	fResults.read((char *) column.data(), nValues * sizeof(T));
+	check((size_t) fResults.gcount() != nValues * sizeof(T), "%s\n", RS_ERROR_FILE_FORMAT);
+}
+
+
+/**
+ * @brief Writes the individuals into a temporary file which replaces the previous results file when it is complete
+ * @param individuals The final front 0 followed by the world
+ * @param nFront The number of individuals in the final front 0
+ * @param conf The structure with all configuration parameters
+ */
+void writeResultsFile(const std::vector<Individual> individuals, const int nFront, const Config *const conf) {
+
+	const int nIndividuals = individuals.size();
+
+
+	/********** Columns of the results ***********/
+
+	Results results;
+	results.header.magic = RS_MAGIC;
+	results.header.version = RS_VERSION;
+	results.header.nFeatures = conf -> nFeatures;
+	results.header.nObjectives = conf -> nObjectives;
+	results.header.nFront = nFront;
+	results.header.nWorld = nIndividuals - nFront;
+	results.objectives.resize((size_t) conf -> nObjectives * nIndividuals);
+	results.normalizedObjectives.resize((size_t) conf -> nObjectives * nIndividuals);
+	results.featureOffsets.push_back(0);
+	for (int i = 0; i < nIndividuals; ++i) {
+		results.subpopulation.push_back((i < nFront) ? -1 : (i - nFront) / conf -> subpopulationSize);
+		results.rank.push_back(individuals[i].rank);
+		results.crowding.push_back(individuals[i].crowding);
+		for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
+			results.objectives[((size_t) obj * nIndividuals) + i] = individuals[i].rawFitness[obj];
+			results.normalizedObjectives[((size_t) obj * nIndividuals) + i] = individuals[i].fitness[obj];
+		}
+		for (int f = 0; f < conf -> nFeatures; ++f) {
+			if (individuals[i].chromosome[f]) {
+				results.features.push_back(f);
+			}
+		}
+		results.featureOffsets.push_back(results.features.size());
+	}
+
+
+	/********** Write the file ***********/
+
+	std::string tmpFileName = conf -> resultsFileName + ".tmp";
+	std::fstream fResults(tmpFileName.c_str(), std::fstream::out | std::fstream::binary | std::fstream::trunc);
+	check(!fResults.is_open(), "%s\n", RS_ERROR_FILE_OPEN);
+	fResults.write((const char *) &(results.header), sizeof(ResultsHeader));
+	writeColumn(fResults, results.subpopulation);
+	writeColumn(fResults, results.rank);
+	writeColumn(fResults, results.crowding);
+	writeColumn(fResults, results.objectives);
+	writeColumn(fResults, results.normalizedObjectives);
+	writeColumn(fResults, results.featureOffsets);
+	writeColumn(fResults, results.features);
+	fResults.close();
+	check(fResults.fail() || rename(tmpFileName.c_str(), conf -> resultsFileName.c_str()) != 0, "%s\n", RS_ERROR_FILE_WRITE);
+}
+
+
+/**
+ * @brief Writes the final front 0 and, optionally, the world into the results file. The raw objectives are the ones kept by "normalizeFitness" and the file is written by a background thread, so the shutdown is not stalled
+ * @param front The final front 0
+ * @param nFront The number of individuals in the final front 0
+ * @param world The parents of all subpopulations, one subpopulation after another, or an empty vector if the world is not written
+ * @param conf The structure with all configuration parameters
+ */
+void writeResults(const Individual *const front, const int nFront, std::vector<Individual> world, const Config *const conf) {
+
+	world.insert(world.begin(), front, front + nFront);
+	waitResults();
+	writer = std::thread(writeResultsFile, std::move(world), nFront, conf);
+}
+
+
+/**
+ * @brief Waits until the results file has been completely written. It must be called before releasing the configuration
+ */
+void waitResults() {
+
+	if (writer.joinable()) {
+		writer.join();
+	}
+}
+
+
+/**
+ * @brief Reads a results file
+ * @param fileName The name of the results file
+ * @return The content of the file
+ */
+Results readResults(const char *const fileName) {
+
+	Results results;
+	std::fstream fResults(fileName, std::fstream::in | std::fstream::binary);
+	check(!fResults.is_open(), "%s\n", RS_ERROR_FILE_OPEN);
+	fResults.read((char *) &(results.header), sizeof(ResultsHeader));
+	check(fResults.gcount() != sizeof(ResultsHeader) || results.header.magic != RS_MAGIC || results.header.version != RS_VERSION, "%s\n", RS_ERROR_FILE_FORMAT);
+
+	const size_t nIndividuals = (size_t) results.header.nFront + results.header.nWorld;
+	readColumn(fResults, results.subpopulation, nIndividuals);
+	readColumn(fResults, results.rank, nIndividuals);
+	readColumn(fResults, results.crowding, nIndividuals);
+	readColumn(fResults, results.objectives, results.header.nObjectives * nIndividuals);
+	readColumn(fResults, results.normalizedObjectives, results.header.nObjectives * nIndividuals);
+	readColumn(fResults, results.featureOffsets, nIndividuals + 1);
+	readColumn(fResults, results.features, results.featureOffsets.back());
+	fResults.close();
+
+	return results;
+}
@@ -0,0 +1,334 @@
+/**
+ * @file transport.cpp
+ * @author Juan José Escobar Pérez
+ * @date 19/10/2026
+ * @brief File with the implementation of the transports used by the master, the workers and the peer migrations of the islands-based model
+ */
+
+/********************************* Includes *******************************/
+
+#include "transport.h"
+#include <algorithm> // std::min
+#include <string.h> // memcpy
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Sends a message without blocking. The data is copied, so the buffer can be reused immediately
+ * @param data The message
+ * @param nBytes The size of the message in bytes
+ * @param dest The destination process
+ * @param tag The tag of the message
+ */
+void MPITransport::send(const void *const data, const int nBytes, const int dest, const int tag) {
+
+	std::lock_guard<std::mutex> lock(this -> pendingMutex);
+
+	// The buffers of the messages already sent are released
+	auto buffer = this -> pendingBuffers.begin();
+	for (auto request = this -> pendingRequests.begin(); request != this -> pendingRequests.end();) {
+		int completed;
+		MPI_Test(&(*request), &completed, MPI_STATUS_IGNORE);
+		if (completed) {
+			request = this -> pendingRequests.erase(request);
+			buffer = this -> pendingBuffers.erase(buffer);
+		}
+		else {
+			++request;
+			++buffer;
+		}
+	}
+
+	this -> pendingBuffers.push_back(std::vector<unsigned char>((const unsigned char *) data, (const unsigned char *) data + nBytes));
+	this -> pendingRequests.push_back(MPI_REQUEST_NULL);
+	MPI_Isend(this -> pendingBuffers.back().data(), nBytes, MPI_BYTE, dest, tag, MPI_COMM_WORLD, &(this -> pendingRequests.back()));
+}
+
+
+/**
+ * @brief Receives the oldest message from the specified process. The messages of each process are received in order
+ * @param buffer The buffer where the message will be stored
+ * @param maxBytes The size of the buffer in bytes
+ * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+ * @param tag The tag of the received message
+ * @return The source of the received message
+ */
+int MPITransport::recv(void *const buffer, const int maxBytes, const int source, int *const tag) {
+
+	MPI_Status status;
+	MPI_Recv(buffer, maxBytes, MPI_BYTE, (source == TRANSPORT_ANY_SOURCE) ? MPI_ANY_SOURCE : source, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+	*tag = status.MPI_TAG;
+	return status.MPI_SOURCE;
+}
+
+
+/**
+ * @brief Posts the receive of the next message from the specified process without blocking. The buffer can not be used until the receive is completed
+ * @param buffer The buffer where the message will be stored
+ * @param maxBytes The size of the buffer in bytes
+ * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+ * @param request The posted receive
+ */
+void MPITransport::irecv(void *const buffer, const int maxBytes, const int source, TransportRequest *const request) {
+
+	request -> buffer = buffer;
+	request -> maxBytes = maxBytes;
+	request -> source = source;
+	MPI_Irecv(buffer, maxBytes, MPI_BYTE, (source == TRANSPORT_ANY_SOURCE) ? MPI_ANY_SOURCE : source, MPI_ANY_TAG, MPI_COMM_WORLD, &(request -> request));
+}
+
+
+/**
+ * @brief Checks if a posted receive has been completed without blocking
+ * @param request The posted receive
+ * @param tag The tag of the received message
+ * @return The source of the received message, or -1 if the message has not arrived yet
+ */
+int MPITransport::test(TransportRequest *const request, int *const tag) {
+
+	MPI_Status status;
+	int completed;
+	MPI_Test(&(request -> request), &completed, &status);
+	if (!completed) {
+		return -1;
+	}
+	*tag = status.MPI_TAG;
+	return status.MPI_SOURCE;
+}
+
+
+/**
+ * @brief Blocks until a posted receive is completed
+ * @param request The posted receive
+ * @param tag The tag of the received message
+ * @return The source of the received message
+ */
+int MPITransport::wait(TransportRequest *const request, int *const tag) {
+
+	MPI_Status status;
+	MPI_Wait(&(request -> request), &status);
+	*tag = status.MPI_TAG;
+	return status.MPI_SOURCE;
+}
+
+
+/**
+ * @brief Checks if a message from the specified process has arrived without receiving it
+ * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+ * @param wait If it must block until a message arrives
+ * @param nBytes The size in bytes of the oldest message of the returned process
+ * @return The source of the message, or -1 if no message has arrived
+ */
+int MPITransport::probe(const int source, const bool wait, int *const nBytes) {
+
+	MPI_Status status;
+	int arrived = true;
+	if (wait) {
+		MPI_Probe((source == TRANSPORT_ANY_SOURCE) ? MPI_ANY_SOURCE : source, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+	}
+	else {
+		MPI_Iprobe((source == TRANSPORT_ANY_SOURCE) ? MPI_ANY_SOURCE : source, MPI_ANY_TAG, MPI_COMM_WORLD, &arrived, &status);
+	}
+	if (!arrived) {
+		return -1;
+	}
+	MPI_Get_count(&status, MPI_BYTE, nBytes);
+	return status.MPI_SOURCE;
+}
+
+
+/**
+ * @brief Waits until all the messages sent by this process have left their buffers
+ */
+void MPITransport::flush() {
+
+	std::lock_guard<std::mutex> lock(this -> pendingMutex);
+	for (auto request = this -> pendingRequests.begin(); request != this -> pendingRequests.end(); ++request) {
+		MPI_Wait(&(*request), MPI_STATUS_IGNORE);
+	}
+	this -> pendingRequests.clear();
+	this -> pendingBuffers.clear();
+}
+
+
+/**
+ * @brief Blocks until all processes have called it
+ */
+void MPITransport::barrier() {
+
+	MPI_Barrier(MPI_COMM_WORLD);
+}
+
+
+/**
+ * @brief The constructor with parameters
+ * @param nProcesses The number of simulated processes
+ */
+LocalHub::LocalHub(const int nProcesses) : mailboxes(nProcesses) {
+
+	this -> nWaiting = 0;
+	this -> barrierGeneration = 0;
+}
+
+
+/**
+ * @brief The constructor with parameters
+ * @param hub The mailboxes shared by all simulated processes
+ * @param rank The identifier of the simulated process
+ */
+LocalTransport::LocalTransport(LocalHub *const hub, const int rank) {
+
+	this -> hub = hub;
+	this -> rank = rank;
+}
+
+
+/**
+ * @brief Sends a message without blocking. The data is copied, so the buffer can be reused immediately
+ * @param data The message
+ * @param nBytes The size of the message in bytes
+ * @param dest The destination process
+ * @param tag The tag of the message
+ */
+void LocalTransport::send(const void *const data, const int nBytes, const int dest, const int tag) {
+
+	LocalMessage message;
+	message.source = this -> rank;
+	message.tag = tag;
+	message.data.assign((const unsigned char *) data, (const unsigned char *) data + nBytes);
+
+	std::lock_guard<std::mutex> lock(this -> hub -> mutex);
+	this -> hub -> mailboxes[dest].push_back(std::move(message));
+	this -> hub -> arrived.notify_all();
+}
+
+
+/**
+ * @brief Receives the oldest message from the specified process. The messages of each process are received in order
+ * @param buffer The buffer where the message will be stored
+ * @param maxBytes The size of the buffer in bytes
+ * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+ * @param tag The tag of the received message
+ * @return The source of the received message
+ */
+int LocalTransport::recv(void *const buffer, const int maxBytes, const int source, int *const tag) {
+
+	std::unique_lock<std::mutex> lock(this -> hub -> mutex);
+	std::deque<LocalMessage> &mailbox = this -> hub -> mailboxes[this -> rank];
+	while (true) {
+		for (auto message = mailbox.begin(); message != mailbox.end(); ++message) {
+			if (source == TRANSPORT_ANY_SOURCE || message -> source == source) {
+				int messageSource = message -> source;
+				memcpy(buffer, message -> data.data(), std::min((int) message -> data.size(), maxBytes));
+				*tag = message -> tag;
+				mailbox.erase(message);
+				return messageSource;
+			}
+		}
+		this -> hub -> arrived.wait(lock);
+	}
+}
+
+
+/**
+ * @brief Posts the receive of the next message from the specified process without blocking. The messages are already in memory, so the receive is matched when it is tested or waited
+ * @param buffer The buffer where the message will be stored
+ * @param maxBytes The size of the buffer in bytes
+ * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+ * @param request The posted receive
+ */
+void LocalTransport::irecv(void *const buffer, const int maxBytes, const int source, TransportRequest *const request) {
+
+	request -> request = MPI_REQUEST_NULL;
+	request -> buffer = buffer;
+	request -> maxBytes = maxBytes;
+	request -> source = source;
+}
+
+
+/**
+ * @brief Checks if a posted receive has been completed without blocking
+ * @param request The posted receive
+ * @param tag The tag of the received message
+ * @return The source of the received message, or -1 if the message has not arrived yet
+ */
+int LocalTransport::test(TransportRequest *const request, int *const tag) {
+
+	std::lock_guard<std::mutex> lock(this -> hub -> mutex);
+	std::deque<LocalMessage> &mailbox = this -> hub -> mailboxes[this -> rank];
+	for (auto message = mailbox.begin(); message != mailbox.end(); ++message) {
+		if (request -> source == TRANSPORT_ANY_SOURCE || message -> source == request -> source) {
+			int messageSource = message -> source;
+			memcpy(request -> buffer, message -> data.data(), std::min((int) message -> data.size(), request -> maxBytes));
+			*tag = message -> tag;
+			mailbox.erase(message);
+			return messageSource;
+		}
+	}
+	return -1;
+}
+
+
+/**
+ * @brief Blocks until a posted receive is completed
+ * @param request The posted receive
+ * @param tag The tag of the received message
+ * @return The source of the received message
+ */
+int LocalTransport::wait(TransportRequest *const request, int *const tag) {
+
+	return recv(request -> buffer, request -> maxBytes, request -> source, tag);
+}
+
+
+/**
+ * @brief Checks if a message from the specified process has arrived without receiving it
+ * @param source The source process, or "TRANSPORT_ANY_SOURCE"
+ * @param wait If it must block until a message arrives
+ * @param nBytes The size in bytes of the oldest message of the returned process
+ * @return The source of the message, or -1 if no message has arrived
+ */
+int LocalTransport::probe(const int source, const bool wait, int *const nBytes) {
+
+	std::unique_lock<std::mutex> lock(this -> hub -> mutex);
+	std::deque<LocalMessage> &mailbox = this -> hub -> mailboxes[this -> rank];
+	while (true) {
+		for (auto message = mailbox.begin(); message != mailbox.end(); ++message) {
+			if (source == TRANSPORT_ANY_SOURCE || message -> source == source) {
+				*nBytes = message -> data.size();
+				return message -> source;
+			}
+		}
+		if (!wait) {
+			return -1;
+		}
+		this -> hub -> arrived.wait(lock);
+	}
+}
+
+
+/**
+ * @brief Waits until all the messages sent by this process have left their buffers. The messages are copied when they are sent, so there is nothing to wait
+ */
+void LocalTransport::flush() {
+}
+
+
+/**
+ * @brief Blocks until all processes have called it
+ */
+void LocalTransport::barrier() {
+
+	std::unique_lock<std::mutex> lock(this -> hub -> mutex);
+	int generation = this -> hub -> barrierGeneration;
+	if (++(this -> hub -> nWaiting) == (int) this -> hub -> mailboxes.size()) {
+		this -> hub -> nWaiting = 0;
+		++(this -> hub -> barrierGeneration);
+		this -> hub -> arrived.notify_all();
+	}
+	else {
+		while (generation == this -> hub -> barrierGeneration) {
+			this -> hub -> arrived.wait(lock);
+		}
+	}
+}